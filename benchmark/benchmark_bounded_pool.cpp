@@ -0,0 +1,113 @@
+#include <vector>
+#include <numeric>
+#include <iostream>
+#include <thread>
+#include <array>
+
+#include "catch.hpp"
+#include "benchmark_helpers.hpp"
+#include "bounded_pool.hpp"
+
+namespace benchmark_bounded_pool{
+    using value_type = std::vector<float>;
+    static constexpr std::size_t pool_size = 256;
+    static constexpr std::size_t buffer_size = 256*1024;   //1MB buffers, LIFO pool reuses buffer from L2, FIFO pool of 256MB is larger than L3
+    static constexpr std::size_t n_iterations = 1000;
+}
+
+//pop buffer, process it and release, FIFO pool hands out least recently used buffer, LIFO pool reuses cache hot buffer
+TEMPLATE_TEST_CASE("benchmark_bounded_pool_buffer_reuse","[benchmark_bounded_pool]",
+    (bounded_pool::mc_bounded_pool<benchmark_bounded_pool::value_type>),
+    (bounded_pool::mc_bounded_lifo_pool<benchmark_bounded_pool::value_type>)
+)
+{
+    using benchmark_helpers::cpu_timer;
+    using pool_type = TestType;
+    using value_type = benchmark_bounded_pool::value_type;
+    using benchmark_bounded_pool::pool_size;
+    using benchmark_bounded_pool::buffer_size;
+    using benchmark_bounded_pool::n_iterations;
+
+    const value_type buffer_(buffer_size);
+    pool_type pool{pool_size, buffer_};
+    auto start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_iterations; ++i){
+        auto buffer = pool.pop();
+        for (auto& v : buffer.get()){
+            v += 1.0f;
+        }
+    }
+    auto stop = cpu_timer{};
+
+    std::cout<<std::endl<<typeid(pool_type).name()<<" buffer reuse, ms "<<stop-start;
+    double sum{0};
+    {
+        std::vector<decltype(pool.pop())> buffers{};
+        while(auto buffer = pool.try_pop()){
+            sum = std::accumulate(buffer.get().begin(), buffer.get().end(), sum);
+            buffers.push_back(buffer);
+        }
+    }
+    REQUIRE(sum == static_cast<double>(n_iterations*buffer_size));
+    REQUIRE(pool.size() == pool_size);
+}
+
+//threads repeatedly pop and release object, cached pool mostly reuses objects from thread's magazine without touching shared pool
+TEMPLATE_TEST_CASE("benchmark_bounded_pool_acquire_release","[benchmark_bounded_pool]",
+    (bounded_pool::mc_bounded_pool<std::size_t>),
+    (bounded_pool::mc_bounded_lifo_pool<std::size_t>),
+    (bounded_pool::mc_bounded_cached_pool<std::size_t>)
+)
+{
+    using benchmark_helpers::cpu_timer;
+    using pool_type = TestType;
+    static constexpr std::size_t n_threads = 4;
+    static constexpr std::size_t n_iterations = 100*1000;
+
+    pool_type pool{benchmark_bounded_pool::pool_size};
+    std::array<std::thread, n_threads> threads{};
+    auto start = cpu_timer{};
+    for (auto& t : threads){
+        t = std::thread{[&pool](){
+            for (std::size_t i{0}; i!=n_iterations; ++i){
+                ++pool.pop().get();
+            }
+        }};
+    }
+    std::for_each(threads.begin(),threads.end(),[](auto& t){t.join();});
+    auto stop = cpu_timer{};
+
+    std::cout<<std::endl<<typeid(pool_type).name()<<" acquire release, ms "<<stop-start;
+    std::size_t sum{0};
+    {
+        std::vector<decltype(pool.pop())> objects{};
+        while(auto e = pool.try_pop()){
+            sum += e.get();
+            objects.push_back(e);
+        }
+    }
+    REQUIRE(sum == n_threads*n_iterations);
+}
+
+//single owner acquire and release, unique_element returns object to pool without use count updates
+TEST_CASE("benchmark_bounded_pool_shared_unique","[benchmark_bounded_pool]")
+{
+    using benchmark_helpers::cpu_timer;
+    using pool_type = bounded_pool::mc_bounded_lifo_pool<std::size_t>;
+    static constexpr std::size_t n_iterations = 10*1000*1000;
+
+    pool_type pool{benchmark_bounded_pool::pool_size};
+    auto start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_iterations; ++i){
+        ++pool.pop().get();
+    }
+    auto stop = cpu_timer{};
+    std::cout<<std::endl<<"shared_element acquire release, ms "<<stop-start;
+    start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_iterations; ++i){
+        ++pool.pop_unique().get();
+    }
+    stop = cpu_timer{};
+    std::cout<<std::endl<<"unique_element acquire release, ms "<<stop-start;
+    REQUIRE(pool.pop().get() == 2*n_iterations);
+}
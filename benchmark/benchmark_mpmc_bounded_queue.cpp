@@ -25,7 +25,9 @@ namespace benchmark_mpmc_bounded_queue{
 TEMPLATE_TEST_CASE("benchmark_mpmc_bounded_queue_not_blocking_interface","[benchmark_mpmc_bounded_queue]",
     (queue::mpmc_bounded_queue_v1<benchmark_mpmc_bounded_queue::value_type>),
     (queue::mpmc_bounded_queue_v2<benchmark_mpmc_bounded_queue::value_type>),
-    (queue::mpmc_bounded_queue_v3<benchmark_mpmc_bounded_queue::value_type>)
+    (queue::mpmc_bounded_queue_v3<benchmark_mpmc_bounded_queue::value_type>),
+    (queue::mpmc_bounded_queue_v4<benchmark_mpmc_bounded_queue::value_type>),
+    (queue::mpmc_elimination_queue<benchmark_mpmc_bounded_queue::value_type>)
 )
 {
     using benchmark_helpers::make_ranges;
@@ -93,7 +95,9 @@ TEMPLATE_TEST_CASE("benchmark_mpmc_bounded_queue_not_blocking_interface","[bench
 TEMPLATE_TEST_CASE("benchmark_mpmc_bounded_queue_blocking_interface","[benchmark_mpmc_bounded_queue]",
     (queue::mpmc_bounded_queue_v1<benchmark_mpmc_bounded_queue::value_type>),
     (queue::mpmc_bounded_queue_v2<benchmark_mpmc_bounded_queue::value_type>),
-    (queue::mpmc_bounded_queue_v3<benchmark_mpmc_bounded_queue::value_type>)
+    (queue::mpmc_bounded_queue_v3<benchmark_mpmc_bounded_queue::value_type>),
+    (queue::mpmc_bounded_queue_v4<benchmark_mpmc_bounded_queue::value_type>),
+    (queue::mpmc_elimination_queue<benchmark_mpmc_bounded_queue::value_type>)
 )
 {
     using benchmark_helpers::make_ranges;
@@ -153,4 +157,71 @@ TEMPLATE_TEST_CASE("benchmark_mpmc_bounded_queue_blocking_interface","[benchmark
     REQUIRE(result.size() == expected.size());
     REQUIRE(result == expected);
     REQUIRE(queue.size() == 0);
-}
\ No newline at end of file
+}
+//short ring is often empty or full, so counter cas fails often and elimination exchange is used
+TEMPLATE_TEST_CASE("benchmark_mpmc_bounded_queue_contended","[benchmark_mpmc_bounded_queue]",
+    (queue::mpmc_bounded_queue_v1<benchmark_mpmc_bounded_queue::value_type>),
+    (queue::mpmc_elimination_queue<benchmark_mpmc_bounded_queue::value_type>)
+)
+{
+    using benchmark_helpers::make_ranges;
+    using benchmark_helpers::cpu_timer;
+
+    using queue_type = TestType;
+    using value_type = typename queue_type::value_type;
+    static constexpr std::size_t n_producers = 10;
+    static constexpr std::size_t n_consumers = 10;
+    static constexpr std::size_t n_elements = benchmark_mpmc_bounded_queue::n_elements/10;
+    static constexpr std::size_t capacity = 4;
+
+    queue_type queue{capacity};
+    std::vector<value_type> expected(n_elements);
+    for (std::size_t i{0}; i!=n_elements; ++i){
+        expected[i] = static_cast<value_type>(i);
+    }
+    auto producer_f = [&queue](auto first, auto last){
+        std::for_each(first,last,
+            [&queue](const auto& v){
+                while(!queue.try_push(v)){
+                    std::this_thread::yield();
+                }
+            }
+        );
+    };
+    auto consumer_f = [&queue](auto first, auto last){
+        std::for_each(first,last,
+            [&queue](auto& v){
+                while(!queue.try_pop(v)){
+                    std::this_thread::yield();
+                };
+            }
+        );
+    };
+    std::array<std::thread, n_producers> producers;
+    std::array<std::thread, n_consumers> consumers;
+
+    static constexpr auto producer_ranges = make_ranges<n_elements,n_producers>();
+    static constexpr auto consumer_ranges = make_ranges<n_elements,n_consumers>();
+    std::vector<value_type> result(n_elements);
+    auto producers_it = producers.begin();
+    auto consumers_it = consumers.begin();
+
+    auto start = cpu_timer{};
+    for(auto it = producer_ranges.begin(); it!=producer_ranges.end()-1; ++it,++producers_it){
+        *producers_it = std::thread(producer_f, expected.begin()+*it , expected.begin()+*(it+1));
+    }
+    for(auto it = consumer_ranges.begin(); it!=consumer_ranges.end()-1; ++it,++consumers_it){
+        *consumers_it = std::thread(consumer_f, result.begin()+*it , result.begin()+*(it+1));
+    }
+
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    std::for_each(consumers.begin(),consumers.end(),[](auto& t){t.join();});
+    auto stop = cpu_timer{};
+
+    std::cout<<std::endl<<typeid(queue_type).name()<<" contended data transfer, ms "<<stop-start;
+
+    std::sort(result.begin(),result.end());
+    REQUIRE(result.size() == expected.size());
+    REQUIRE(result == expected);
+    REQUIRE(queue.size() == 0);
+}
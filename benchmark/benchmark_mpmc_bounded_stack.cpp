@@ -0,0 +1,65 @@
+#include <array>
+#include <vector>
+#include <thread>
+#include <iostream>
+
+#include "catch.hpp"
+#include "benchmark_helpers.hpp"
+#include "queue.hpp"
+
+namespace benchmark_mpmc_bounded_stack{
+    using value_type = float*;
+    static constexpr std::size_t n_buffers = 64;
+    static constexpr std::size_t buffer_size = 16*1024;
+    static constexpr std::size_t n_iterations = 1000*1000;
+}
+
+//workers take buffer, write to it and return it back, LIFO container returns recently used buffer that is more likely in cache
+TEMPLATE_TEST_CASE("benchmark_mpmc_bounded_stack_buffer_recycling","[benchmark_mpmc_bounded_stack]",
+    (queue::mpmc_bounded_queue_v1<benchmark_mpmc_bounded_stack::value_type>),
+    (queue::mpmc_bounded_stack<benchmark_mpmc_bounded_stack::value_type>)
+)
+{
+    using benchmark_helpers::cpu_timer;
+
+    using container_type = TestType;
+    using value_type = typename container_type::value_type;
+    static constexpr std::size_t n_workers = 4;
+    static constexpr std::size_t n_buffers = benchmark_mpmc_bounded_stack::n_buffers;
+    static constexpr std::size_t buffer_size = benchmark_mpmc_bounded_stack::buffer_size;
+    static constexpr std::size_t n_iterations = benchmark_mpmc_bounded_stack::n_iterations;
+    static constexpr std::size_t touch_size = 256;
+
+    std::vector<std::vector<float>> buffers(n_buffers, std::vector<float>(buffer_size));
+    container_type container{n_buffers};
+    for (auto& buffer : buffers){
+        container.push(buffer.data());
+    }
+    auto worker_f = [&container](){
+        value_type buffer{};
+        for (std::size_t i{0}; i!=n_iterations/n_workers; ++i){
+            container.pop(buffer);
+            for (std::size_t j{0}; j!=touch_size; ++j){
+                buffer[j] += 1.0f;
+            }
+            container.push(buffer);
+        }
+    };
+    std::array<std::thread, n_workers> workers;
+
+    auto start = cpu_timer{};
+    std::for_each(workers.begin(),workers.end(),[&worker_f](auto& t){t = std::thread(worker_f);});
+    std::for_each(workers.begin(),workers.end(),[](auto& t){t.join();});
+    auto stop = cpu_timer{};
+
+    std::cout<<std::endl<<typeid(container_type).name()<<" buffer recycling, ms "<<stop-start;
+
+    REQUIRE(container.size() == n_buffers);
+    double sum{0};
+    for (const auto& buffer : buffers){
+        for (std::size_t j{0}; j!=touch_size; ++j){
+            sum += buffer[j];
+        }
+    }
+    REQUIRE(sum == static_cast<double>(n_workers*(n_iterations/n_workers)*touch_size));
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <atomic>
+
+#include "catch.hpp"
+#include "benchmark_helpers.hpp"
+#include "thread_pool.hpp"
+
+namespace benchmark_thread_pool{
+    static constexpr std::size_t n_workers = 4;
+    static constexpr std::size_t n_tasks = 1000*1000;
+}
+
+//push many tiny tasks, time is dominated by submission and pop overhead
+TEMPLATE_TEST_CASE("benchmark_thread_pool_tiny_tasks","[benchmark_thread_pool]",
+    thread_pool::thread_pool_v3,
+    thread_pool::thread_pool_v6
+)
+{
+    using benchmark_helpers::cpu_timer;
+    using thread_pool_type = TestType;
+    using thread_pool::task_group;
+    using benchmark_thread_pool::n_workers;
+    using benchmark_thread_pool::n_tasks;
+
+    thread_pool_type pool{n_workers, 1024};
+    task_group group{};
+    std::atomic<std::size_t> counter{0};
+    auto start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_tasks; ++i){
+        pool.push_group(group, [&counter](){counter.fetch_add(1, std::memory_order_relaxed);});
+    }
+    group.wait();
+    auto stop = cpu_timer{};
+
+    std::cout<<std::endl<<typeid(thread_pool_type).name()<<" tiny tasks, ns per task "<<(stop-start)*1000*1000/n_tasks;
+    REQUIRE(counter.load() == n_tasks);
+}
+
+//push task and wait for its result, time is dominated by task future shared state
+TEMPLATE_TEST_CASE("benchmark_thread_pool_push_get","[benchmark_thread_pool]",
+    thread_pool::thread_pool_v3,
+    thread_pool::thread_pool_v6
+)
+{
+    using benchmark_helpers::cpu_timer;
+    using thread_pool_type = TestType;
+    using benchmark_thread_pool::n_workers;
+    static constexpr std::size_t n_tasks = 100*1000;
+
+    thread_pool_type pool{n_workers, 1024};
+    std::size_t std_sum{0};
+    auto start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_tasks; ++i){
+        std_sum += pool.push([](auto x){return x;}, i).get();
+    }
+    auto stop = cpu_timer{};
+    std::cout<<std::endl<<typeid(thread_pool_type).name()<<" push get std::promise, ns per task "<<(stop-start)*1000*1000/n_tasks;
+    std::size_t light_sum{0};
+    start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_tasks; ++i){
+        light_sum += pool.template push<thread_pool::light_promise>([](auto x){return x;}, i).get();
+    }
+    stop = cpu_timer{};
+    std::cout<<std::endl<<typeid(thread_pool_type).name()<<" push get light_promise, ns per task "<<(stop-start)*1000*1000/n_tasks;
+    REQUIRE(std_sum == light_sum);
+}
+
+//fire and forget tasks, push_async constructs promise and shared state that push_detached does not
+TEMPLATE_TEST_CASE("benchmark_thread_pool_push_detached","[benchmark_thread_pool]",
+    thread_pool::thread_pool_v3,
+    thread_pool::thread_pool_v6
+)
+{
+    using benchmark_helpers::cpu_timer;
+    using thread_pool_type = TestType;
+    using benchmark_thread_pool::n_workers;
+    using benchmark_thread_pool::n_tasks;
+
+    thread_pool_type pool{n_workers, 1024};
+    std::atomic<std::size_t> counter{0};
+    auto f = [&counter](){counter.fetch_add(1, std::memory_order_relaxed);};
+    auto start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_tasks; ++i){
+        pool.push_async(f);
+    }
+    while(counter.load() != n_tasks){
+        std::this_thread::yield();
+    }
+    auto stop = cpu_timer{};
+    std::cout<<std::endl<<typeid(thread_pool_type).name()<<" push_async, ns per task "<<(stop-start)*1000*1000/n_tasks;
+    start = cpu_timer{};
+    for (std::size_t i{0}; i!=n_tasks; ++i){
+        pool.push_detached(f);
+    }
+    while(counter.load() != 2*n_tasks){
+        std::this_thread::yield();
+    }
+    stop = cpu_timer{};
+    std::cout<<std::endl<<typeid(thread_pool_type).name()<<" push_detached, ns per task "<<(stop-start)*1000*1000/n_tasks;
+    REQUIRE(counter.load() == 2*n_tasks);
+}
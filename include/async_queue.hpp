@@ -0,0 +1,221 @@
+/*
+* Copyright (c) 2022 Ivan Malezhyk <ivanmzk@gmail.com>
+*
+* Distributed under the Boost Software License, Version 1.0.
+* The full license is in the file LICENSE.txt, distributed with this software.
+*/
+
+#ifndef ASYNC_QUEUE_HPP_
+#define ASYNC_QUEUE_HPP_
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "async_queue.hpp requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include "queue.hpp"
+
+namespace queue{
+
+namespace detail{
+
+template<typename Executor, typename = void>
+struct has_try_push_detached : std::false_type{};
+template<typename Executor>
+struct has_try_push_detached<Executor, std::void_t<decltype(std::declval<Executor&>().try_push_detached(std::declval<void(*)()>()))>> : std::true_type{};
+
+}   //end of namespace detail
+
+//multiple producer multiple consumer queue with awaitable push and pop, built on mpmc_bounded_queue_v1
+//co_await pop_async() and co_await push_async(args...) complete without suspension if element or slot is available,
+//otherwise coroutine is suspended and its handle is added to waiters list
+//items and slots are counted with atomic counters, negative counter value is number of coroutines that wait or are going to wait for element or slot
+//waiters lists are not bounded and guarded by mutex that is locked only when coroutine suspends or element or slot is released to waiter,
+//release that finds no waiter in list yet leaves pending resumption to be taken by suspending coroutine, so no thread waits for other
+//coroutine is resumed on executor when element or slot becomes available, executor should have push_async(f) member, e.g. thread_pool_v3,
+//if executor has try_push_detached(f) and push_detached(f), e.g. thread_pool_v3 or thread_pool_v6, try_push_detached is used,
+//coroutine that doesn't fit full executor queue is added to overflow list, that is drained by resumption tasks of this queue after they resume their coroutine,
+//so coroutine is never resumed by releasing thread and stack doesn't grow, release blocks in push_detached of drain task only if
+//executor queue is full and no resumption task of this queue is queued or running
+//suspended coroutine must not be destroyed, queue must outlive resumption tasks
+template<typename T, typename Executor, typename Allocator = std::allocator<detail::element_v1_<T>>>
+class mpmc_bounded_async_queue
+{
+    using queue_type = mpmc_bounded_queue_v1<T, Allocator>;
+    using counter_type = std::int64_t;
+    using mutex_type = std::mutex;
+    //suspended coroutines and number of releases that found no suspended coroutine
+    struct waiters_type{
+        std::deque<std::coroutine_handle<>> handles{};
+        std::size_t pending{0};
+        mutex_type guard{};
+    };
+    //coroutines that didn't fit executor queue and number of queued or running resumption tasks
+    struct overflow_type{
+        std::deque<std::coroutine_handle<>> handles{};
+        std::size_t tasks{0};
+        mutex_type guard{};
+    };
+public:
+    using value_type = T;
+    using executor_type = Executor;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+
+    class pop_awaiter
+    {
+        mpmc_bounded_async_queue& queue_;
+    public:
+        explicit pop_awaiter(mpmc_bounded_async_queue& queue__):
+            queue_{queue__}
+        {}
+        bool await_ready(){return queue_.items.fetch_sub(1) > 0;}
+        bool await_suspend(std::coroutine_handle<> h){return queue_.suspend(queue_.pop_waiters, h);}
+        value_type await_resume(){
+            auto v = queue_.queue.pop();
+            queue_.release(queue_.slots, queue_.push_waiters);
+            return std::move(v.get());
+        }
+    };
+
+    class push_awaiter
+    {
+        mpmc_bounded_async_queue& queue_;
+        value_type v;
+    public:
+        template<typename...Args>
+        explicit push_awaiter(mpmc_bounded_async_queue& queue__, Args&&...args):
+            queue_{queue__},
+            v{std::forward<Args>(args)...}
+        {}
+        bool await_ready(){return queue_.slots.fetch_sub(1) > 0;}
+        bool await_suspend(std::coroutine_handle<> h){return queue_.suspend(queue_.push_waiters, h);}
+        void await_resume(){
+            queue_.queue.push(std::move(v));
+            queue_.release(queue_.items, queue_.pop_waiters);
+        }
+    };
+
+    mpmc_bounded_async_queue(const mpmc_bounded_async_queue&) = delete;
+    mpmc_bounded_async_queue(mpmc_bounded_async_queue&&) = delete;
+    mpmc_bounded_async_queue& operator=(const mpmc_bounded_async_queue&) = delete;
+    mpmc_bounded_async_queue& operator=(mpmc_bounded_async_queue&&) = delete;
+    mpmc_bounded_async_queue(size_type capacity__, executor_type& executor__, const Allocator& allocator__ = Allocator{}):
+        queue{capacity__, allocator__},
+        executor{executor__},
+        slots{static_cast<counter_type>(capacity__)}
+    {}
+
+    //awaitable that returns popped element
+    auto pop_async(){return pop_awaiter{*this};}
+    //awaitable that pushes element constructed from args
+    template<typename...Args>
+    auto push_async(Args&&...args){return push_awaiter{*this, std::forward<Args>(args)...};}
+
+    //not blocking push and pop, can be used from outside of coroutine
+    template<typename...Args>
+    bool try_push(Args&&...args){
+        if (!try_acquire(slots)){
+            return false;
+        }
+        queue.push(std::forward<Args>(args)...);
+        release(items, pop_waiters);
+        return true;
+    }
+    bool try_pop(value_type& v){
+        if (!try_acquire(items)){
+            return false;
+        }
+        queue.pop(v);
+        release(slots, push_waiters);
+        return true;
+    }
+
+    auto size()const{return queue.size();}
+    auto capacity()const{return queue.capacity();}
+
+private:
+    //decrement counter if it is positive
+    static bool try_acquire(std::atomic<counter_type>& counter){
+        auto counter_ = counter.load();
+        while(counter_ > 0){
+            if (counter.compare_exchange_weak(counter_, counter_-1)){
+                return true;
+            }
+        }
+        return false;
+    }
+    //increment counter and resume waiter if counter was negative
+    //waiter may be not in waiters list yet, then resumption is left pending and waiter takes it when it suspends
+    void release(std::atomic<counter_type>& counter, waiters_type& waiters){
+        if (counter.fetch_add(1) < 0){
+            std::unique_lock<mutex_type> lock{waiters.guard};
+            if (waiters.handles.empty()){
+                ++waiters.pending;
+                return;
+            }
+            auto h = waiters.handles.front();
+            waiters.handles.pop_front();
+            lock.unlock();
+            schedule(h);
+        }
+    }
+    //return false if pending resumption is taken, so coroutine is not suspended
+    bool suspend(waiters_type& waiters, std::coroutine_handle<> h){
+        std::lock_guard<mutex_type> lock{waiters.guard};
+        if (waiters.pending == 0){
+            waiters.handles.push_back(h);
+            return true;
+        }
+        --waiters.pending;
+        return false;
+    }
+    void schedule(std::coroutine_handle<> h){
+        if constexpr (detail::has_try_push_detached<executor_type>::value){
+            std::unique_lock<mutex_type> lock{overflow.guard};
+            ++overflow.tasks;
+            lock.unlock();
+            if (executor.try_push_detached([this, h](){h.resume(); drain();})){
+                return;
+            }
+            lock.lock();
+            overflow.handles.push_back(h);
+            if (--overflow.tasks != 0){//queued or running task drains overflow
+                return;
+            }
+            ++overflow.tasks;
+            lock.unlock();
+            executor.push_detached([this](){drain();});
+        }else{
+            executor.push_async([h](){h.resume();});
+        }
+    }
+    //called by resumption task, resume coroutines of overflow list one by one until it is empty
+    void drain(){
+        std::unique_lock<mutex_type> lock{overflow.guard};
+        while(!overflow.handles.empty()){
+            auto h = overflow.handles.front();
+            overflow.handles.pop_front();
+            lock.unlock();
+            h.resume();
+            lock.lock();
+        }
+        --overflow.tasks;
+    }
+
+    queue_type queue;
+    waiters_type pop_waiters;
+    waiters_type push_waiters;
+    overflow_type overflow;
+    executor_type& executor;
+    std::atomic<counter_type> items{0};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding_;
+    std::atomic<counter_type> slots;
+};
+
+}   //end of namespace queue
+
+#endif
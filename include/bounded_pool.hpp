@@ -8,15 +8,23 @@
 #ifndef BOUNDED_POOL_HPP_
 #define BOUNDED_POOL_HPP_
 
+#include <chrono>
+#include <functional>
+#include <tuple>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "queue.hpp"
 
 namespace bounded_pool{
 
 namespace detail{
 
+//lock free queue of references to pool elements, pop and try_pop return pointer to element, try_pop returns nullptr if queue is empty or next push is not complete
 class queue_of_refs
 {
-    using queue_type = queue::mpmc_bounded_queue_v3<void*>;
+    using queue_type = queue::mpmc_bounded_pointer_queue<void>;
     queue_type refs;
 public:
     queue_of_refs(std::size_t capacity_):
@@ -27,13 +35,371 @@ public:
     void push(void* ref){refs.push(ref);}
     auto pop(){return refs.pop();}
     auto try_pop(){return refs.try_pop();}
+    //all or nothing pop of n references, n tickets are reserved at once
+    template<typename It>
+    bool try_pop_n(It first, std::size_t n){return refs.try_pop_exactly(first, n);}
+    template<typename It>
+    void pop_n(It first, std::size_t n){refs.pop_exactly(first, n);}
 };
 
-template<typename T>
+//lock free stack of references to pool elements, most recently pushed element is popped first
+class stack_of_refs
+{
+    using stack_type = queue::mpmc_bounded_stack<void*>;
+    stack_type refs;
+public:
+    stack_of_refs(std::size_t capacity_):
+        refs{capacity_}
+    {}
+    auto size()const{return refs.size();}
+    auto capacity()const{return refs.capacity();}
+    void push(void* ref){refs.push(ref);}
+    void* pop(){return refs.pop().get();}
+    void* try_pop(){
+        void* ref{nullptr};
+        refs.try_pop(ref);
+        return ref;
+    }
+    //all or nothing pop of n references, top n references are popped at once
+    //most recently pushed references are reused again and again, oldest ones at the bottom may starve while load is below capacity
+    template<typename It>
+    bool try_pop_n(It first, std::size_t n){return refs.try_pop_exactly(first, n);}
+    template<typename It>
+    void pop_n(It first, std::size_t n){refs.pop_exactly(first, n);}
+};
+
+//thread local magazines of references in front of shared Pool (queue_of_refs or stack_of_refs)
+//magazine of thread is created on its first pop, after that pop and push of this thread use magazine and touch shared Pool only to refill or flush
+//refill moves up to MagazineSize/2 references from shared Pool to empty magazine, flush moves MagazineSize/2 references from full magazine to shared Pool
+//push of thread that never popped goes to shared Pool, magazine is flushed to shared Pool when thread exits
+//magazine is spmc_bounded_deque, owner pushes and pops at its bottom without locks and read-modify-write, only pop has fence
+//when shared Pool runs dry pop drains magazines of all threads to shared Pool by stealing at top, owner and drain race only for last reference,
+//so pop doesn't block while other threads cache free references
+//size() is number of references in shared Pool and in magazines
+template<typename Pool, std::size_t MagazineSize>
+class cached_refs
+{
+    static_assert(MagazineSize > 1);
+    static constexpr std::size_t batch_size = MagazineSize/2;
+
+    //owner thread pushes and pops at bottom, other threads only steal at top to drain magazine
+    struct magazine_refs{
+        queue::spmc_bounded_deque<void> refs{MagazineSize};
+    };
+    //shared Pool and magazines of threads that popped from it
+    struct shared_type{
+        explicit shared_type(std::size_t capacity_):
+            pool{capacity_}
+        {}
+        Pool pool;
+        mutable std::mutex guard{};
+        std::vector<std::shared_ptr<magazine_refs>> magazines{};  //guarded by guard
+    };
+    struct magazine{
+        std::uint64_t id;
+        std::weak_ptr<shared_type> shared;
+        std::shared_ptr<magazine_refs> refs;
+    };
+    //magazines of current thread, one per cached_refs object thread popped from
+    class magazines_type
+    {
+        std::vector<magazine> magazines{};
+    public:
+        ~magazines_type()
+        {
+            for (auto& m : magazines){
+                if (auto shared = m.shared.lock()){
+                    std::lock_guard<std::mutex> shared_lock{shared->guard};
+                    flush(shared->pool, *m.refs, MagazineSize);
+                    shared->magazines.erase(std::find(shared->magazines.begin(), shared->magazines.end(), m.refs));
+                }
+            }
+        }
+        magazine* find(std::uint64_t id){
+            auto it = std::find_if(magazines.begin(), magazines.end(), [id](const auto& m){return m.id == id;});
+            return it == magazines.end() ? nullptr : &*it;
+        }
+        magazine* emplace(std::uint64_t id, const std::shared_ptr<shared_type>& shared){
+            //magazines of destroyed pools are dropped, their references are dangling
+            magazines.erase(std::remove_if(magazines.begin(), magazines.end(), [](const auto& m){return m.shared.expired();}), magazines.end());
+            auto refs = std::make_shared<magazine_refs>();
+            {
+                std::lock_guard<std::mutex> lock{shared->guard};
+                shared->magazines.push_back(refs);
+            }
+            return &magazines.emplace_back(magazine{id, shared, std::move(refs)});
+        }
+    };
+
+    inline static std::atomic<std::uint64_t> ids{0};
+    inline static thread_local magazines_type magazines{};
+
+    std::uint64_t id{ids.fetch_add(1, std::memory_order_relaxed)};
+    std::shared_ptr<shared_type> shared;   //shared ownership, thread exit may flush magazine concurrently with pool destruction
+
+    magazine_refs& get_magazine(){
+        if (auto m = magazines.find(id)){
+            return *m->refs;
+        }
+        return *magazines.emplace(id, shared)->refs;
+    }
+    //move up to n least recently pushed references from magazine to shared Pool, stops when steal loses race for last reference
+    static void flush(Pool& pool, magazine_refs& m, std::size_t n){
+        for (; n!=0; --n){
+            if (auto ref = m.refs.try_steal()){
+                pool.push(ref);
+            }else{
+                break;
+            }
+        }
+    }
+    //called after first reference is popped from shared pool, so up to batch_size-1 more references are moved to magazine
+    void refill(magazine_refs& m){
+        for (auto size = m.refs.size(); size<batch_size-1; ++size){
+            if (auto ref = shared->pool.try_pop()){
+                m.refs.try_push(ref);
+            }else{
+                break;
+            }
+        }
+    }
+    //move references of all magazines to shared Pool
+    void drain(){
+        std::lock_guard<std::mutex> lock{shared->guard};
+        for (auto& m : shared->magazines){
+            flush(shared->pool, *m, MagazineSize);
+        }
+    }
+    void* try_pop_(magazine_refs& m){
+        if (auto ref = m.refs.try_pop()){
+            return ref;
+        }
+        auto ref = shared->pool.try_pop();
+        if (ref){
+            refill(m);
+        }
+        return ref;
+    }
+    //if drain steals from magazine while references are popped, popped ones are pushed back
+    template<typename It>
+    bool try_pop_n_(magazine_refs& m, It first, std::size_t n){
+        if (m.refs.size() >= n){
+            std::array<void*, MagazineSize> popped;
+            std::size_t k{0};
+            for (; k!=n; ++k){
+                if (auto ref = m.refs.try_pop()){
+                    popped[k] = ref;
+                }else{
+                    break;
+                }
+            }
+            if (k == n){
+                std::copy(popped.begin(), popped.begin()+n, first);
+                return true;
+            }
+            while(k!=0){
+                m.refs.try_push(popped[--k]);
+            }
+        }
+        return shared->pool.try_pop_n(first, n);
+    }
+public:
+    cached_refs(std::size_t capacity_):
+        shared{std::make_shared<shared_type>(capacity_)}
+    {}
+    auto size()const{
+        std::lock_guard<std::mutex> lock{shared->guard};
+        auto res = shared->pool.size();
+        for (const auto& m : shared->magazines){
+            res += m->refs.size();
+        }
+        return res;
+    }
+    auto capacity()const{return shared->pool.capacity();}
+    void push(void* ref){
+        if (auto m = magazines.find(id)){
+            auto& refs = *m->refs;
+            if (refs.refs.size() >= MagazineSize){//flush least recently pushed references, keep cache hot ones
+                flush(shared->pool, refs, batch_size);
+            }
+            if (!refs.refs.try_push(ref)){
+                shared->pool.push(ref);
+            }
+        }else{
+            shared->pool.push(ref);
+        }
+    }
+    void* pop(){
+        auto& m = get_magazine();
+        while(true){
+            if (auto ref = try_pop_(m)){
+                return ref;
+            }
+            drain();
+            if (auto ref = try_pop_(m)){
+                return ref;
+            }
+            std::this_thread::yield();
+        }
+    }
+    void* try_pop(){
+        auto& m = get_magazine();
+        if (auto ref = try_pop_(m)){
+            return ref;
+        }
+        drain();
+        return try_pop_(m);
+    }
+    //n references are taken from magazine if it has enough of them, from shared Pool otherwise
+    template<typename It>
+    bool try_pop_n(It first, std::size_t n){
+        auto& m = get_magazine();
+        if (try_pop_n_(m, first, n)){
+            return true;
+        }
+        drain();
+        return try_pop_n_(m, first, n);
+    }
+    template<typename It>
+    void pop_n(It first, std::size_t n){
+        auto& m = get_magazine();
+        while(!try_pop_n_(m, first, n)){
+            drain();
+            if (try_pop_n_(m, first, n)){
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+};
+
+//queue of references to idle elements of elastic pool, remembers time when number of idle elements exceeded high watermark
+//shrink is optional hook, that is called after element is pushed, so surplus is trimmed on release too
+class elastic_refs
+{
+    using clock_type = std::chrono::steady_clock;
+    using shrink_type = std::function<void()>;
+    queue_of_refs refs;
+    std::size_t high_watermark;
+    shrink_type shrink;
+    std::atomic<clock_type::rep> surplus_since_{0};   //zero if there is no surplus
+public:
+    elastic_refs(std::size_t capacity_, std::size_t high_watermark_, shrink_type shrink_ = shrink_type{}):
+        refs{capacity_},
+        high_watermark{high_watermark_},
+        shrink{std::move(shrink_)}
+    {}
+    auto size()const{return refs.size();}
+    auto capacity()const{return refs.capacity();}
+    void push(void* ref){
+        refs.push(ref);
+        if (size() > high_watermark && surplus_since_.load(std::memory_order_relaxed) == 0){
+            clock_type::rep expected{0};
+            surplus_since_.compare_exchange_strong(expected, clock_type::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+        if (shrink){
+            shrink();
+        }
+    }
+    auto pop(){return refs.pop();}
+    auto try_pop(){return refs.try_pop();}
+    //true if number of idle elements is above high watermark for longer than decay
+    bool surplus_decayed(clock_type::duration decay){
+        auto since = surplus_since_.load(std::memory_order_relaxed);
+        if (since == 0){
+            return false;
+        }
+        if (size() <= high_watermark){
+            surplus_since_.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return clock_type::now().time_since_epoch() - clock_type::duration{since} >= decay;
+    }
+    void reset_surplus(){surplus_since_.store(0, std::memory_order_relaxed);}
+    auto get_high_watermark()const{return high_watermark;}
+};
+
+//queue of references to idle elements that resets element when it is released
+//reset is called by releasing thread, or by background thread if async is true, element is pushed to queue after it is reset
+class recycling_refs
+{
+    using mutex_type = std::mutex;
+    using reset_type = std::function<void(void*)>;
+    queue_of_refs refs;
+    reset_type reset;
+    std::vector<void*> pending{};
+    bool stop_{false};
+    mutex_type pending_guard{};
+    std::condition_variable has_pending{};
+    std::thread worker{};
+
+    void recycle(){
+        std::vector<void*> pending_{};
+        pending_.reserve(refs.capacity());
+        while(true){
+            {
+                std::unique_lock<mutex_type> lock{pending_guard};
+                has_pending.wait(lock, [this]{return stop_ || !pending.empty();});
+                if (pending.empty()){//stopped and all released elements are reset
+                    return;
+                }
+                std::swap(pending, pending_);
+            }
+            std::for_each(pending_.begin(), pending_.end(), [this](auto ref){reset(ref); refs.push(ref);});
+            pending_.clear();
+        }
+    }
+public:
+    recycling_refs(std::size_t capacity_, reset_type reset_, bool async):
+        refs{capacity_},
+        reset{std::move(reset_)}
+    {
+        if (reset && async){
+            pending.reserve(capacity_);
+            worker = std::thread{[this]{recycle();}};
+        }
+    }
+    ~recycling_refs()
+    {
+        stop();
+    }
+    auto size()const{return refs.size();}
+    auto capacity()const{return refs.capacity();}
+    void push(void* ref){
+        if (worker.joinable()){
+            {
+                std::lock_guard<mutex_type> lock{pending_guard};
+                pending.push_back(ref);
+            }
+            has_pending.notify_one();
+        }else{
+            if (reset){
+                reset(ref);
+            }
+            refs.push(ref);
+        }
+    }
+    auto pop(){return refs.pop();}
+    auto try_pop(){return refs.try_pop();}
+    //reset pending elements and join background thread
+    void stop(){
+        if (worker.joinable()){
+            {
+                std::lock_guard<mutex_type> lock{pending_guard};
+                stop_ = true;
+            }
+            has_pending.notify_one();
+            worker.join();
+        }
+    }
+};
+
+//Pool is queue_of_refs, stack_of_refs, cached_refs, elastic_refs or recycling_refs, element returns itself to pool when its use count drops to zero
+template<typename T, typename Pool = queue_of_refs>
 class shareable_element{
     using value_type = T;
-    using pool_type = queue_of_refs;
 public:
+    using pool_type = Pool;
     template<typename...Args>
     shareable_element(pool_type* pool_, Args&&...args):
         pool{pool_},
@@ -46,6 +412,14 @@ public:
     static auto make_empty_shared(){
         return shared_element{nullptr};
     }
+    auto make_unique(){
+        return unique_element{this};
+    }
+    static auto make_empty_unique(){
+        return unique_element{nullptr};
+    }
+    auto& get(){return value;}
+    auto& get()const{return value;}
 private:
     pool_type* pool;
     value_type value;
@@ -53,7 +427,7 @@ private:
 
     class shared_element{
         friend class shareable_element;
-        shareable_element* elem;
+        shareable_element* elem{nullptr};
         shared_element(shareable_element* elem_):
             elem{elem_}
         {}
@@ -105,6 +479,55 @@ private:
         auto& get()const{return elem->get();}
     };
 
+    //single owner of element, returns element to pool when destroyed, use count is not touched
+    //rvalue converts to shared_element when sharing is needed
+    class unique_element{
+        friend class shareable_element;
+        shareable_element* elem{nullptr};
+        unique_element(shareable_element* elem_):
+            elem{elem_}
+        {}
+        void release(){
+            if (elem){
+                elem->pool->push(elem);
+            }
+        }
+    public:
+        ~unique_element()
+        {
+            release();
+        }
+        unique_element() = default;
+        unique_element(const unique_element&) = delete;
+        unique_element& operator=(const unique_element&) = delete;
+        unique_element(unique_element&& other):
+            elem{other.elem}
+        {
+            other.elem = nullptr;
+        }
+        unique_element& operator=(unique_element&& other){
+            release();
+            elem = other.elem;
+            other.elem = nullptr;
+            return *this;
+        }
+        operator shared_element()&&{
+            auto e = elem;
+            elem = nullptr;
+            if (e){
+                e->inc_ref();
+            }
+            return shared_element{e};
+        }
+        operator bool()const{return static_cast<bool>(elem);}
+        void reset(){
+            release();
+            elem = nullptr;
+        }
+        auto& get(){return elem->get();}
+        auto& get()const{return elem->get();}
+    };
+
     auto inc_ref(){return use_count_.fetch_add(1);}
     auto dec_ref(){
         if (use_count_.fetch_sub(1) == 1){
@@ -112,19 +535,42 @@ private:
         }
     }
     auto use_count()const{return use_count_.load();}
-    auto& get(){return value;}
-    auto& get()const{return value;}
+};
+
+//output iterator that makes shared_element of element which reference is assigned to it and assigns it to underlying iterator
+template<typename Element, typename It>
+class make_shared_iterator
+{
+    It it;
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+    explicit make_shared_iterator(It it_):
+        it{it_}
+    {}
+    make_shared_iterator& operator*(){return *this;}
+    make_shared_iterator& operator++(){return *this;}
+    make_shared_iterator& operator++(int){return *this;}
+    make_shared_iterator& operator=(void* ref){
+        *it = static_cast<Element*>(ref)->make_shared();
+        ++it;
+        return *this;
+    }
 };
 
 }   //end of namespace detail
 
 //multiple consumer bounded pool of reusable objects
+//reuse policy is defined by pool_type of allocator's value_type, objects are reused in FIFO order by default
 template<typename T, typename Allocator = std::allocator<detail::shareable_element<T>>>
 class mc_bounded_pool
 {
 
     using element_type = typename std::allocator_traits<Allocator>::value_type;
-    using pool_type = detail::queue_of_refs;
+    using pool_type = typename element_type::pool_type;
 
 public:
     using value_type = T;
@@ -158,28 +604,61 @@ public:
     //after last copy of shared_element object is destroyed reusable object is returned to pool and ready to new use
     //blocks until reusable object is available
     auto pop(){
-        return static_cast<element_type*>(pool.pop().get())->make_shared();
+        return static_cast<element_type*>(pool.pop())->make_shared();
     }
 
     //not blocking, if no reusable objects available returns immediately
     //result, that is shared_element object, can be converted to bool and test, false if no objects available, true otherwise
     auto try_pop(){
         if (auto e = pool.try_pop()){
-            return static_cast<element_type*>(e.get())->make_shared();
+            return static_cast<element_type*>(e)->make_shared();
         }else{
             return element_type::make_empty_shared();
         }
     }
 
+    //all or nothing, if n objects are available assign their shared_element objects to range starting from first and return true, return false otherwise
+    //objects are reserved in one batched operation of underlying free list
+    template<typename It>
+    bool try_pop_n(It first, std::size_t n){
+        check_n(n);
+        return pool.try_pop_n(detail::make_shared_iterator<element_type, It>{first}, n);
+    }
+    //blocks until n objects are acquired at once, so threads that wait for sets of objects do not hold partial sets
+    //FIFO pool reserves n objects in order of calls, LIFO pool retries until n objects are available
+    template<typename It>
+    void pop_n(It first, std::size_t n){
+        check_n(n);
+        pool.pop_n(detail::make_shared_iterator<element_type, It>{first}, n);
+    }
+
+    //like pop and try_pop but return move only unique_element, that returns object to pool when destroyed without use count updates
+    //unique_element rvalue converts to shared_element
+    auto pop_unique(){
+        return static_cast<element_type*>(pool.pop())->make_unique();
+    }
+    auto try_pop_unique(){
+        if (auto e = pool.try_pop()){
+            return static_cast<element_type*>(e)->make_unique();
+        }else{
+            return element_type::make_empty_unique();
+        }
+    }
+
     auto size()const{return pool.size();}
     auto capacity()const{return pool.capacity();}
     auto empty()const{return size() == 0;}
 private:
+    void check_n(std::size_t n)const{
+        if (n > capacity()){
+            throw std::invalid_argument("number of objects to pop must not be greater than pool capacity");
+        }
+    }
     template<typename...Args>
     void init(Args&&...args){
         auto it = elements;
         auto end = elements+capacity();
-        for(;it!=end;++it){new(it) element_type{&pool, std::forward<Args>(args)...};}
+        for(;it!=end;++it){new(it) element_type{&pool, args...};}   //args are copied to every element, not forwarded
         init_pool();
     }
 
@@ -197,6 +676,275 @@ private:
     element_type* elements;
 };
 
+//pool that reuses most recently released object first, it is more likely to be in cache
+template<typename T>
+using mc_bounded_lifo_pool = mc_bounded_pool<T, std::allocator<detail::shareable_element<T, detail::stack_of_refs>>>;
+
+//pool with per thread magazines of MagazineSize free objects, threads that repeatedly pop and release objects mostly do not touch shared pool
+template<typename T, std::size_t MagazineSize = 16>
+using mc_bounded_cached_pool = mc_bounded_pool<T, std::allocator<detail::shareable_element<T, detail::cached_refs<detail::stack_of_refs, MagazineSize>>>>;
+
+namespace detail{
+
+//base of pools that construct objects on demand in storage allocated for capacity objects
+//objects are constructed from copies of constructor args, storage of destroyed object is vacant again
+//Derived implements pop_() and try_pop_() that return element_type*, try_pop_() returns nullptr if there is no object to pop
+template<typename Derived, typename Allocator>
+class on_demand_pool
+{
+protected:
+    using element_type = typename std::allocator_traits<Allocator>::value_type;
+    using pool_type = typename element_type::pool_type;
+    using vacant_type = queue_of_refs;
+    using size_type = std::size_t;
+
+    template<typename...Args>
+    on_demand_pool(size_type capacity__, pool_type* pool, Args&&...args):
+        allocator{Allocator{}},
+        vacant{capacity__},
+        construct{[pool, args_ = std::make_tuple(std::forward<Args>(args)...)](element_type* e){
+            std::apply([pool, e](const auto&...args__){new(e) element_type{pool, args__...};}, args_);
+        }},
+        elements{allocator.allocate(capacity__)}
+    {
+        std::for_each(elements, elements+capacity__, [this](auto& e){vacant.push(&e);});
+    }
+    //derived destructor must destroy all constructed objects
+    ~on_demand_pool()
+    {
+        allocator.deallocate(elements, vacant.capacity());
+    }
+    //construct element in vacant storage, return nullptr if all elements are constructed
+    void* try_make_element(){
+        if (auto e = vacant.try_pop()){
+            try{
+                construct(static_cast<element_type*>(e));
+            }catch(...){
+                vacant.push(e);
+                throw;
+            }
+            constructed_.fetch_add(1, std::memory_order_relaxed);
+            return e;
+        }
+        return nullptr;
+    }
+    void destroy_element(void* e){
+        std::destroy_at(static_cast<element_type*>(e));
+        constructed_.fetch_sub(1, std::memory_order_relaxed);
+        vacant.push(e);
+    }
+    auto constructed_number()const{return constructed_.load(std::memory_order_relaxed);}
+public:
+    on_demand_pool(const on_demand_pool&) = delete;
+    on_demand_pool(on_demand_pool&&) = delete;
+    on_demand_pool& operator=(const on_demand_pool&) = delete;
+    on_demand_pool& operator=(on_demand_pool&&) = delete;
+
+    //returns shared_element object, constructs new object if there is no idle one and capacity objects are not constructed yet
+    //blocks until object is available
+    auto pop(){
+        return derived().pop_()->make_shared();
+    }
+    //not blocking, result converts to false if there is no idle object and all objects are constructed
+    auto try_pop(){
+        if (auto e = derived().try_pop_()){
+            return e->make_shared();
+        }else{
+            return element_type::make_empty_shared();
+        }
+    }
+    //like pop and try_pop but return move only unique_element
+    auto pop_unique(){
+        return derived().pop_()->make_unique();
+    }
+    auto try_pop_unique(){
+        if (auto e = derived().try_pop_()){
+            return e->make_unique();
+        }else{
+            return element_type::make_empty_unique();
+        }
+    }
+private:
+    Derived& derived(){return static_cast<Derived&>(*this);}
+
+    Allocator allocator;
+    vacant_type vacant;
+    std::function<void(element_type*)> construct;
+    element_type* elements;
+    std::atomic<size_type> constructed_{0};
+};
+
+}   //end of namespace detail
+
+//multiple consumer pool of reusable objects that grows when runs dry and shrinks when objects are idle
+//low_watermark objects are constructed when pool is created, when there is no idle object pop constructs new one until hard_limit objects are constructed
+//when number of idle objects stays above high_watermark longer than decay, surplus idle objects are destroyed on next pop, try_pop, release or shrink call
+//objects are constructed from copies of constructor args
+//storage for hard_limit objects is allocated when pool is created, memory owned by objects is allocated and freed with objects
+template<typename T, typename Allocator = std::allocator<detail::shareable_element<T, detail::elastic_refs>>>
+class mc_elastic_pool : public detail::on_demand_pool<mc_elastic_pool<T, Allocator>, Allocator>
+{
+    using base_type = detail::on_demand_pool<mc_elastic_pool<T, Allocator>, Allocator>;
+    using typename base_type::element_type;
+    using typename base_type::pool_type;
+    using mutex_type = std::mutex;
+    static_assert(std::is_same_v<pool_type, detail::elastic_refs>);
+    friend base_type;
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using duration_type = std::chrono::steady_clock::duration;
+
+    template<typename...Args>
+    mc_elastic_pool(size_type low_watermark, size_type high_watermark, size_type hard_limit, duration_type decay__, Args&&...args):
+        base_type{check_limits(low_watermark, high_watermark, hard_limit), &pool, std::forward<Args>(args)...},
+        pool{hard_limit, high_watermark, [this](){shrink();}},
+        decay{decay__}
+    {
+        try{
+            for (size_type i{0}; i!=low_watermark; ++i){
+                pool.push(this->try_make_element());
+            }
+        }catch(...){
+            clear();
+            throw;
+        }
+    }
+
+    ~mc_elastic_pool()
+    {
+        clear();
+    }
+
+    //destroy idle objects above high watermark if they are idle longer than decay
+    void shrink(){
+        if (!pool.surplus_decayed(decay)){
+            return;
+        }
+        std::unique_lock<mutex_type> lock{shrink_guard, std::try_to_lock};
+        if (!lock){
+            return;
+        }
+        while(pool.size() > pool.get_high_watermark()){
+            if (auto e = pool.try_pop()){
+                this->destroy_element(e);
+            }else{
+                break;
+            }
+        }
+        pool.reset_surplus();
+    }
+
+    //number of idle objects
+    auto size()const{return pool.size();}
+    //number of constructed objects
+    auto capacity()const{return this->constructed_number();}
+    auto hard_limit()const{return pool.capacity();}
+    auto empty()const{return size() == 0;}
+
+private:
+    element_type* pop_(){
+        auto e = pool.try_pop();
+        if (!e){
+            e = this->try_make_element();
+            if (!e){
+                e = pool.pop();
+            }
+        }
+        shrink();
+        return static_cast<element_type*>(e);
+    }
+    element_type* try_pop_(){
+        auto e = pool.try_pop();
+        if (!e){
+            e = this->try_make_element();
+        }
+        shrink();
+        return static_cast<element_type*>(e);
+    }
+    static size_type check_limits(size_type low_watermark, size_type high_watermark, size_type hard_limit){
+        if (hard_limit == 0){
+            throw std::invalid_argument("pool hard limit must be > 0");
+        }
+        if (low_watermark > high_watermark || high_watermark > hard_limit){
+            throw std::invalid_argument("pool limits must be low_watermark <= high_watermark <= hard_limit");
+        }
+        return hard_limit;
+    }
+    //all objects must be idle
+    void clear(){
+        while(auto e = pool.try_pop()){
+            this->destroy_element(e);
+        }
+    }
+
+    pool_type pool;
+    duration_type decay;
+    mutex_type shrink_guard{};
+};
+
+//multiple consumer pool of reusable objects that constructs objects on first acquisition
+//when there is no idle object pop constructs new one until capacity objects are constructed, objects are constructed from copies of constructor args
+//reset is optional hook, that is called for object when it is released, so object is clean when it is reused
+//if async_reset is true reset is called by background thread, released object is idle after it is reset
+//reset must not throw, it is called from shared_element and unique_element destructors
+template<typename T, typename Allocator = std::allocator<detail::shareable_element<T, detail::recycling_refs>>>
+class mc_lazy_pool : public detail::on_demand_pool<mc_lazy_pool<T, Allocator>, Allocator>
+{
+    using base_type = detail::on_demand_pool<mc_lazy_pool<T, Allocator>, Allocator>;
+    using typename base_type::element_type;
+    using typename base_type::pool_type;
+    static_assert(std::is_same_v<pool_type, detail::recycling_refs>);
+    friend base_type;
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using reset_type = std::function<void(value_type&)>;
+
+    template<typename...Args>
+    mc_lazy_pool(size_type capacity__, reset_type reset, bool async_reset, Args&&...args):
+        base_type{capacity__, &pool, std::forward<Args>(args)...},
+        pool{capacity__, make_reset(std::move(reset)), async_reset}
+    {}
+
+    ~mc_lazy_pool()
+    {
+        pool.stop();
+        while(auto e = pool.try_pop()){
+            this->destroy_element(e);
+        }
+    }
+
+    //number of idle objects
+    auto size()const{return pool.size();}
+    auto capacity()const{return pool.capacity();}
+    //number of constructed objects
+    auto constructed()const{return this->constructed_number();}
+    auto empty()const{return size() == 0;}
+
+private:
+    static std::function<void(void*)> make_reset(reset_type reset){
+        if (reset){
+            return [reset_ = std::move(reset)](void* e){reset_(static_cast<element_type*>(e)->get());};
+        }
+        return {};
+    }
+    element_type* pop_(){
+        auto e = try_pop_();
+        return e ? e : static_cast<element_type*>(pool.pop());
+    }
+    element_type* try_pop_(){
+        auto e = pool.try_pop();
+        if (!e){
+            e = this->try_make_element();
+        }
+        return static_cast<element_type*>(e);
+    }
+
+    pool_type pool;
+};
 
 }   //end of namespace bounded_pool
 
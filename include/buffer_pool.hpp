@@ -0,0 +1,359 @@
+/*
+* Copyright (c) 2022 Ivan Malezhyk <ivanmzk@gmail.com>
+*
+* Distributed under the Boost Software License, Version 1.0.
+* The full license is in the file LICENSE.txt, distributed with this software.
+*/
+
+#ifndef BUFFER_POOL_HPP_
+#define BUFFER_POOL_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <memory_resource>
+#include <system_error>
+#include <cerrno>
+#include <cstddef>
+#include <unistd.h>
+#include <sys/mman.h>
+#if __has_include(<span>)
+#include <span>
+#endif
+#include "bounded_pool.hpp"
+
+namespace bounded_pool{
+
+namespace detail{
+
+//anonymous private memory mapping, optionally populated and locked in RAM
+class mapped_region
+{
+public:
+    mapped_region(const mapped_region&) = delete;
+    mapped_region(mapped_region&&) = delete;
+    mapped_region& operator=(const mapped_region&) = delete;
+    mapped_region& operator=(mapped_region&&) = delete;
+    mapped_region(std::size_t size__, bool populate, bool lock):
+        size_{size__}
+    {
+        int flags = MAP_PRIVATE|MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+        if (populate){
+            flags |= MAP_POPULATE;
+        }
+#endif
+        auto p = ::mmap(nullptr, size_, PROT_READ|PROT_WRITE, flags, -1, 0);
+        if (p == MAP_FAILED){
+            throw std::system_error(errno, std::generic_category(), "buffer pool mmap failed");
+        }
+        data_ = static_cast<std::byte*>(p);
+        if (lock && ::mlock(data_, size_) == -1){
+            const auto error = errno;
+            ::munmap(data_, size_);
+            throw std::system_error(error, std::generic_category(), "buffer pool mlock failed");
+        }
+    }
+    ~mapped_region()
+    {
+        ::munmap(data_, size_);
+    }
+    auto data()const{return data_;}
+    auto size()const{return size_;}
+private:
+    std::size_t size_;
+    std::byte* data_;
+};
+
+}   //end of namespace detail
+
+//fixed size memory buffer of buffer_pool, not owning
+class buffer
+{
+    std::byte* data_;
+    std::size_t size_;
+public:
+    buffer(std::byte* data__, std::size_t size__):
+        data_{data__},
+        size_{size__}
+    {}
+    auto data()const{return data_;}
+    auto size()const{return size_;}
+    auto begin()const{return data_;}
+    auto end()const{return data_+size_;}
+#ifdef __cpp_lib_span
+    auto span()const{return std::span<std::byte>{data_, size_};}
+#endif
+};
+
+//multiple consumer pool of fixed size aligned buffers carved out of one memory mapped region
+//buffers are handed out as shared_element or unique_element of buffer, most recently released buffer is reused first
+//alignment must be power of two, buffer size is rounded up to alignment, default alignment is page size
+//if populate is true region pages are allocated when pool is created, if lock is true region is locked in RAM (pinned)
+class buffer_pool
+{
+    using pool_type = mc_bounded_lifo_pool<buffer>;
+public:
+    using value_type = buffer;
+    using size_type = std::size_t;
+
+    buffer_pool(const buffer_pool&) = delete;
+    buffer_pool(buffer_pool&&) = delete;
+    buffer_pool& operator=(const buffer_pool&) = delete;
+    buffer_pool& operator=(buffer_pool&&) = delete;
+    buffer_pool(size_type buffers_number, size_type buffer_size__, size_type alignment__ = page_size(), bool populate = false, bool lock = false):
+        buffer_size_{buffer_size__},
+        alignment_{check_alignment(alignment__)},
+        stride{(buffer_size_+alignment_-1)/alignment_*alignment_},
+        region{region_size(buffers_number), populate, lock},
+        pool{make_buffers(buffers_number)}
+    {}
+
+    //see mc_bounded_pool
+    auto pop(){return pool.pop();}
+    auto try_pop(){return pool.try_pop();}
+    auto pop_unique(){return pool.pop_unique();}
+    auto try_pop_unique(){return pool.try_pop_unique();}
+
+    auto size()const{return pool.size();}
+    auto capacity()const{return pool.capacity();}
+    auto empty()const{return pool.empty();}
+    auto buffer_size()const{return buffer_size_;}
+    auto alignment()const{return alignment_;}
+
+    static size_type page_size(){return static_cast<size_type>(::sysconf(_SC_PAGESIZE));}
+
+private:
+    static size_type check_alignment(size_type alignment__){
+        if (alignment__ == 0 || (alignment__ & (alignment__-1)) != 0){
+            throw std::invalid_argument("buffer alignment must be power of two");
+        }
+        return alignment__;
+    }
+    //region is page aligned, alignment above page size needs extra space to align first buffer
+    size_type region_size(size_type buffers_number)const{
+        if (buffers_number == 0 || buffer_size_ == 0){
+            throw std::invalid_argument("buffers number and buffer size must be > 0");
+        }
+        return buffers_number*stride + (alignment_ > page_size() ? alignment_ : 0);
+    }
+    pool_type make_buffers(size_type buffers_number)const{
+        auto space = region.size();
+        void* first = region.data();
+        std::align(alignment_, buffers_number*stride, first, space);
+        std::vector<buffer> buffers{};
+        buffers.reserve(buffers_number);
+        for (size_type i{0}; i!=buffers_number; ++i){
+            buffers.emplace_back(static_cast<std::byte*>(first)+i*stride, buffer_size_);
+        }
+        return pool_type{buffers.begin(), buffers.end()};
+    }
+
+    size_type buffer_size_;
+    size_type alignment_;
+    size_type stride;
+    detail::mapped_region region;
+    pool_type pool;
+};
+
+//snapshot of size class statistics of size_class_pool
+struct size_class_stats{
+    std::size_t buffer_size;
+    std::size_t capacity;
+    std::size_t idle;   //buffers in pool
+    std::size_t acquired;   //buffers handed out by class
+    std::size_t fallbacks;  //buffers handed out by class because smaller fitting class was empty
+    std::size_t failures;   //try_pop calls that found class and all bigger classes empty
+};
+
+//multiple consumer pool of buffers of several size classes, each class is buffer_pool with its own mmaped slab and lock free free list
+//pop and try_pop select smallest class which buffer size is not less than requested size, if it is empty bigger classes are tried
+//pop blocks on smallest fitting class if all fitting classes are empty
+//classes are pairs of buffer size and buffers number, buffer sizes must be different, default alignment is cache line size
+class size_class_pool
+{
+    struct size_class{
+        size_class(std::size_t buffers_number, std::size_t buffer_size, std::size_t alignment, bool populate, bool lock):
+            pool{buffers_number, buffer_size, alignment, populate, lock}
+        {}
+        buffer_pool pool;
+        std::atomic<std::size_t> acquired{0};
+        std::atomic<std::size_t> fallbacks{0};
+        std::atomic<std::size_t> failures{0};
+    };
+public:
+    using value_type = buffer;
+    using size_type = std::size_t;
+
+    size_class_pool(const size_class_pool&) = delete;
+    size_class_pool(size_class_pool&&) = delete;
+    size_class_pool& operator=(const size_class_pool&) = delete;
+    size_class_pool& operator=(size_class_pool&&) = delete;
+    size_class_pool(std::vector<std::pair<size_type, size_type>> classes__, size_type alignment = queue::detail::hardware_destructive_interference_size, bool populate = false, bool lock = false)
+    {
+        if (classes__.empty()){
+            throw std::invalid_argument("size class pool must have at least one class");
+        }
+        std::sort(classes__.begin(), classes__.end());
+        if (std::adjacent_find(classes__.begin(), classes__.end(), [](const auto& l, const auto& r){return l.first == r.first;}) != classes__.end()){
+            throw std::invalid_argument("size classes must have different buffer sizes");
+        }
+        classes.reserve(classes__.size());
+        for (const auto& c : classes__){
+            classes.push_back(std::make_unique<size_class>(c.second, c.first, alignment, populate, lock));
+        }
+    }
+
+    //return shared_element of buffer which size is not less than size, throws invalid_argument if size is greater than biggest buffer size
+    auto pop(size_type size){return pop_(size, [](auto& pool){return pool.try_pop();}, [](auto& pool){return pool.pop();});}
+    //not blocking, result converts to false if all fitting classes are empty
+    auto try_pop(size_type size){return try_pop_(size, [](auto& pool){return pool.try_pop();});}
+    //like above but return unique_element
+    auto pop_unique(size_type size){return pop_(size, [](auto& pool){return pool.try_pop_unique();}, [](auto& pool){return pool.pop_unique();});}
+    auto try_pop_unique(size_type size){return try_pop_(size, [](auto& pool){return pool.try_pop_unique();});}
+
+    auto classes_number()const{return classes.size();}
+    size_class_stats stats(size_type class_index)const{
+        const auto& c = *classes[class_index];
+        return size_class_stats{
+            c.pool.buffer_size(),
+            c.pool.capacity(),
+            c.pool.size(),
+            c.acquired.load(std::memory_order_relaxed),
+            c.fallbacks.load(std::memory_order_relaxed),
+            c.failures.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    //index of smallest fitting class
+    size_type fitting_class(size_type size)const{
+        auto it = std::lower_bound(classes.begin(), classes.end(), size, [](const auto& c, auto size_){return c->pool.buffer_size() < size_;});
+        if (it == classes.end()){
+            throw std::invalid_argument("requested size is greater than biggest buffer size");
+        }
+        return static_cast<size_type>(it - classes.begin());
+    }
+    //try fitting classes from smallest to biggest
+    template<typename TryPop>
+    auto try_pop_fitting(size_type first, TryPop try_pop)->decltype(try_pop(std::declval<buffer_pool&>())){
+        auto e = try_pop(classes[first]->pool);
+        auto i = first;
+        while(!e && ++i!=classes.size()){
+            e = try_pop(classes[i]->pool);
+        }
+        if (e){
+            classes[i]->acquired.fetch_add(1, std::memory_order_relaxed);
+            if (i != first){
+                classes[i]->fallbacks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        return e;
+    }
+    template<typename TryPop>
+    auto try_pop_(size_type size, TryPop try_pop)->decltype(try_pop(std::declval<buffer_pool&>())){
+        const auto first = fitting_class(size);
+        auto e = try_pop_fitting(first, try_pop);
+        if (!e){
+            classes[first]->failures.fetch_add(1, std::memory_order_relaxed);
+        }
+        return e;
+    }
+    template<typename TryPop, typename Pop>
+    auto pop_(size_type size, TryPop try_pop, Pop pop)->decltype(pop(std::declval<buffer_pool&>())){
+        const auto first = fitting_class(size);
+        if (auto e = try_pop_fitting(first, try_pop)){
+            return e;
+        }
+        classes[first]->acquired.fetch_add(1, std::memory_order_relaxed);
+        return pop(classes[first]->pool);
+    }
+
+    std::vector<std::unique_ptr<size_class>> classes;
+};
+
+//memory resource of fixed size blocks carved out of one memory mapped region, blocks are kept in lock free free list
+//requests that are bigger than block size or need bigger alignment than block alignment, and requests when all blocks are in use, go to upstream resource
+//block size is rounded up to alignment, alignment must be power of two
+class pool_resource : public std::pmr::memory_resource
+{
+    using pool_type = detail::stack_of_refs;
+public:
+    using size_type = std::size_t;
+
+    pool_resource(const pool_resource&) = delete;
+    pool_resource(pool_resource&&) = delete;
+    pool_resource& operator=(const pool_resource&) = delete;
+    pool_resource& operator=(pool_resource&&) = delete;
+    pool_resource(size_type blocks_number, size_type block_size__, size_type alignment__ = alignof(std::max_align_t), std::pmr::memory_resource* upstream__ = std::pmr::get_default_resource(), bool populate = false, bool lock = false):
+        alignment_{check_alignment(alignment__)},
+        block_size_{(block_size__+alignment_-1)/alignment_*alignment_},
+        region{region_size(blocks_number), populate, lock},
+        pool{blocks_number},
+        upstream_{upstream__}
+    {
+        auto space = region.size();
+        void* first = region.data();
+        std::align(alignment_, blocks_number*block_size_, first, space);
+        blocks = static_cast<std::byte*>(first);
+        for (size_type i{0}; i!=blocks_number; ++i){
+            pool.push(blocks+i*block_size_);
+        }
+    }
+
+    auto block_size()const{return block_size_;}
+    auto alignment()const{return alignment_;}
+    auto blocks_number()const{return pool.capacity();}
+    //number of free blocks
+    auto size()const{return pool.size();}
+    auto upstream_resource()const{return upstream_;}
+
+private:
+    void* do_allocate(size_type bytes, size_type alignment__)override{
+        if (bytes <= block_size_ && alignment__ <= alignment_){
+            if (auto p = pool.try_pop()){
+                return p;
+            }
+        }
+        return upstream_->allocate(bytes, alignment__);
+    }
+    void do_deallocate(void* p, size_type bytes, size_type alignment__)override{
+        if (owns(p)){
+            pool.push(p);
+        }else{
+            upstream_->deallocate(p, bytes, alignment__);
+        }
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other)const noexcept override{
+        return this == &other;
+    }
+
+    bool owns(const void* p)const{
+        auto p_ = static_cast<const std::byte*>(p);
+        return std::less_equal<const std::byte*>{}(blocks, p_) && std::less<const std::byte*>{}(p_, blocks+blocks_number()*block_size_);
+    }
+    static size_type check_alignment(size_type alignment__){
+        if (alignment__ == 0 || (alignment__ & (alignment__-1)) != 0){
+            throw std::invalid_argument("block alignment must be power of two");
+        }
+        return alignment__;
+    }
+    size_type region_size(size_type blocks_number)const{
+        if (blocks_number == 0 || block_size_ == 0){
+            throw std::invalid_argument("blocks number and block size must be > 0");
+        }
+        return blocks_number*block_size_ + (alignment_ > buffer_pool::page_size() ? alignment_ : 0);
+    }
+
+    size_type alignment_;
+    size_type block_size_;
+    detail::mapped_region region;
+    pool_type pool;
+    std::pmr::memory_resource* upstream_;
+    std::byte* blocks;
+};
+
+}   //end of namespace bounded_pool
+
+#endif
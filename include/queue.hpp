@@ -15,6 +15,15 @@
 #include <new>
 #include <memory>
 #include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <iterator>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <functional>
+#include <algorithm>
 
 namespace queue{
 
@@ -114,6 +123,7 @@ private:
     void clear(){
         if (!empty_){
             element__.destroy();
+            empty_ = true;
         }
     }
     void init(const element& other){
@@ -133,6 +143,108 @@ private:
     bool empty_{true};
 };
 
+//eventcount, blocks threads until condition becomes true, notify doesn't lock if there are no waiters
+//waiter calls prepare_wait(), checks condition, then calls cancel_wait() if condition is true or wait(key) otherwise
+//notifier makes condition true, then calls notify_one() or notify_all()
+class event_count
+{
+    using size_type = std::size_t;
+    using mutex_type = std::mutex;
+public:
+    size_type prepare_wait(){
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  //pairs with fence in notify_
+        return epoch.load(std::memory_order_relaxed);
+    }
+    void cancel_wait(){
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    //blocks until notify is called after prepare_wait returned key
+    void wait(size_type key){
+        std::unique_lock<mutex_type> lock{guard};
+        while(epoch.load(std::memory_order_relaxed) == key){
+            notified.wait(lock);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    //like above but returns false if deadline is reached and not notified
+    template<typename Clock, typename Duration>
+    bool wait_until(size_type key, const std::chrono::time_point<Clock,Duration>& deadline){
+        std::unique_lock<mutex_type> lock{guard};
+        auto res = notified.wait_until(lock, deadline, [this,key](){return epoch.load(std::memory_order_relaxed) != key;});
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return res;
+    }
+    void notify_one(){notify_(false);}
+    void notify_all(){notify_(true);}
+private:
+    void notify_(bool all){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) != 0){
+            std::unique_lock<mutex_type> lock{guard};
+            epoch.fetch_add(1, std::memory_order_relaxed);
+            lock.unlock();
+            if (all){
+                notified.notify_all();
+            }else{
+                notified.notify_one();
+            }
+        }
+    }
+
+    std::atomic<size_type> epoch{0};
+    std::atomic<size_type> waiters{0};
+    mutex_type guard{};
+    std::condition_variable notified{};
+};
+
+//thread local xorshift generator, returns index in range [0,n)
+inline std::size_t random_index(std::size_t n){
+    thread_local std::uint32_t state = static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state%n;
+}
+
+//yield until queue's try_pop_n pops at least one element or timeout expires
+template<typename Queue, typename It, typename Rep, typename Period>
+auto pop_n_(Queue& queue, It first, std::size_t n, const std::chrono::duration<Rep,Period>& timeout){
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while(true){
+        if (auto popped = queue.try_pop_n(first, n)){
+            return popped;
+        }
+        if (n == 0 || std::chrono::steady_clock::now() >= deadline){
+            return decltype(queue.try_pop_n(first, n)){0};
+        }
+        std::this_thread::yield();
+    }
+}
+
+//like above but waiter is parked on has_element eventcount, that must be notified after every push
+template<typename Queue, typename It, typename Rep, typename Period>
+auto pop_n_(Queue& queue, event_count& has_element, It first, std::size_t n, const std::chrono::duration<Rep,Period>& timeout){
+    using size_type = decltype(queue.try_pop_n(first, n));
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while(true){
+        if (auto popped = queue.try_pop_n(first, n)){
+            return popped;
+        }
+        if (n == 0){
+            return size_type{0};
+        }
+        auto key = has_element.prepare_wait();
+        if (auto popped = queue.try_pop_n(first, n)){
+            has_element.cancel_wait();
+            return popped;
+        }
+        if (!has_element.wait_until(key, deadline)){
+            return queue.try_pop_n(first, n);
+        }
+    }
+}
+
 }   //end of namespace detail
 
 //multiple producer multiple consumer bounded queue
@@ -169,23 +281,7 @@ public:
     //if there is empty slot construct element from args in it and return true, return false otherwise
     template<typename...Args>
     bool try_push(Args&&...args){
-        auto push_counter_ = push_counter.load(std::memory_order::memory_order_relaxed);
-        while(true){
-            auto& element = elements[index(push_counter_)];
-            auto id = element.id.load(std::memory_order::memory_order_acquire);
-            if (id == push_counter_){ //buffer overwrite protection
-                auto next_push_counter = push_counter_+1;
-                if (push_counter.compare_exchange_weak(push_counter_, next_push_counter,std::memory_order::memory_order_relaxed)){
-                    element.emplace(std::forward<Args>(args)...);
-                    element.id.store(next_push_counter, std::memory_order::memory_order_release);
-                    return true;
-                }
-            }else if (id < push_counter_){//queue full, exit
-                return false;
-            }else{//element full, try next
-                push_counter_ = push_counter.load(std::memory_order::memory_order_relaxed);
-            }
-        }
+        return try_push_(no_contention{}, std::forward<Args>(args)...);
     }
 
     //if there is element to pop assign it to v and return true, return false otherwise
@@ -203,13 +299,13 @@ public:
     //not return until push is complete
     template<typename...Args>
     void push(Args&&...args){
-        auto push_counter_ = push_counter.fetch_add(1, std::memory_order::memory_order_relaxed); //reserve
+        auto push_counter_ = push_counter.fetch_add(1, std::memory_order_relaxed); //reserve
         auto& element = elements[index(push_counter_)];
-        while(push_counter_ != element.id.load(std::memory_order::memory_order_acquire)){ //wait until element is empty
+        while(push_counter_ != element.id.load(std::memory_order_acquire)){ //wait until element is empty
             std::this_thread::yield();
         }
         element.emplace(std::forward<Args>(args)...);
-        element.id.store(push_counter_+1, std::memory_order::memory_order_release);
+        element.id.store(push_counter_+1, std::memory_order_release);
     }
 
     //not return until pop is complete
@@ -222,51 +318,129 @@ public:
         return v;
     }
 
-    auto size()const{return push_counter.load(std::memory_order::memory_order_relaxed) - pop_counter.load(std::memory_order::memory_order_relaxed);}
+    //pop up to n elements to range starting at first, not waiting, return number of popped elements
+    //all ready elements are claimed with single pop_counter update
+    template<typename It>
+    size_type try_pop_n(It first, size_type n){
+        if (n == 0){
+            return 0;
+        }
+        n = std::min(n, capacity_);
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
+        while(true){
+            size_type k{0};
+            size_type id{};
+            for (; k!=n; ++k){
+                id = elements[index(pop_counter_+k)].id.load(std::memory_order_acquire);
+                if (id != pop_counter_+k+1){
+                    break;
+                }
+            }
+            if (k == 0){
+                if (id < pop_counter_+1){//queue empty, exit
+                    return 0;
+                }else{//element empty, try next
+                    pop_counter_ = pop_counter.load(std::memory_order_relaxed);
+                }
+            }else if (pop_counter.compare_exchange_weak(pop_counter_, pop_counter_+k, std::memory_order_relaxed)){//pop_counter_ updated when fails
+                for (size_type i{0}; i!=k; ++i, ++first){
+                    auto& element = elements[index(pop_counter_+i)];
+                    element.move(*first);
+                    element.destroy();
+                    element.id.store(pop_counter_+i+capacity_, std::memory_order_release);
+                }
+                return k;
+            }
+        }
+    }
+
+    //wait at most timeout for first element, then pop up to n elements like try_pop_n, return number of popped elements
+    //waiting thread polls queue, blocking_queue parks it instead
+    template<typename It, typename Rep, typename Period>
+    size_type pop_n(It first, size_type n, const std::chrono::duration<Rep,Period>& timeout){
+        return detail::pop_n_(*this, first, n, timeout);
+    }
+
+    auto size()const{return push_counter.load(std::memory_order_relaxed) - pop_counter.load(std::memory_order_relaxed);}
     auto capacity()const{return capacity_;}
 
 private:
+    template<typename, typename> friend class mpmc_elimination_queue;
 
-    template<typename V>
-    bool try_pop_(V& v){
-        auto pop_counter_ = pop_counter.load(std::memory_order::memory_order_relaxed);
+    //called after failed counter cas, returns true if operation is completed elsewhere
+    struct no_contention{
+        bool operator()()const{return false;}
+    };
+
+    template<typename OnContention, typename...Args>
+    bool try_push_(OnContention on_contention, Args&&...args){
+        auto push_counter_ = push_counter.load(std::memory_order_relaxed);
+        while(true){
+            auto& element = elements[index(push_counter_)];
+            auto id = element.id.load(std::memory_order_acquire);
+            if (id == push_counter_){ //buffer overwrite protection
+                auto next_push_counter = push_counter_+1;
+                if (push_counter.compare_exchange_weak(push_counter_, next_push_counter,std::memory_order_relaxed)){
+                    element.emplace(std::forward<Args>(args)...);
+                    element.id.store(next_push_counter, std::memory_order_release);
+                    return true;
+                }
+                if (on_contention()){
+                    return true;
+                }
+                push_counter_ = push_counter.load(std::memory_order_relaxed);
+            }else if (id < push_counter_){//queue full, exit
+                return false;
+            }else{//element full, try next
+                push_counter_ = push_counter.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename V, typename OnContention = no_contention>
+    bool try_pop_(V& v, OnContention on_contention = OnContention{}){
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
         while(true){
             auto& element = elements[index(pop_counter_)];
             auto next_pop_counter = pop_counter_+1;
-            auto id = element.id.load(std::memory_order::memory_order_acquire);
+            auto id = element.id.load(std::memory_order_acquire);
             if (id == next_pop_counter){
-                if (pop_counter.compare_exchange_weak(pop_counter_, next_pop_counter, std::memory_order::memory_order_relaxed)){//pop_counter_ updated when fails
+                if (pop_counter.compare_exchange_weak(pop_counter_, next_pop_counter, std::memory_order_relaxed)){//pop_counter_ updated when fails
                     element.move(v);
                     element.destroy();
-                    element.id.store(pop_counter_+capacity_, std::memory_order::memory_order_release);
+                    element.id.store(pop_counter_+capacity_, std::memory_order_release);
                     return true;
                 }
+                if (on_contention()){
+                    return true;
+                }
+                pop_counter_ = pop_counter.load(std::memory_order_relaxed);
             }else if (id < next_pop_counter){//queue empty, exit
                 return false;
             }else{//element empty, try next
-                pop_counter_ = pop_counter.load(std::memory_order::memory_order_relaxed);
+                pop_counter_ = pop_counter.load(std::memory_order_relaxed);
             }
         }
     }
 
     template<typename V>
     void pop_(V& v){
-        auto pop_counter_ = pop_counter.fetch_add(1, std::memory_order::memory_order_relaxed); //reserve
+        auto pop_counter_ = pop_counter.fetch_add(1, std::memory_order_relaxed); //reserve
         auto next_pop_counter = pop_counter_+1;
         auto& element = elements[index(pop_counter_)];
-        while(next_pop_counter != element.id.load(std::memory_order::memory_order_acquire)){ //wait until element is full
+        while(next_pop_counter != element.id.load(std::memory_order_acquire)){ //wait until element is full
             std::this_thread::yield();
         }
         element.move(v);
         element.destroy();
-        element.id.store(pop_counter_+capacity_, std::memory_order::memory_order_release);
+        element.id.store(pop_counter_+capacity_, std::memory_order_release);
     }
 
     void clear(){
-        auto pop_counter_ = pop_counter.load(std::memory_order::memory_order_relaxed);
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
         for (std::size_t i = 0; i!=capacity_; ++i, ++pop_counter_){
             auto& element = elements[index(pop_counter_)];
-            if (element.id.load(std::memory_order::memory_order_relaxed) == pop_counter_+1){
+            if (element.id.load(std::memory_order_relaxed) == pop_counter_+1){
                 element.destroy();
             }else{
                 break;
@@ -322,18 +496,18 @@ public:
     //if there is empty slot construct element from args in it and return true, return false otherwise
     template<typename...Args>
     bool try_push(Args&&...args){
-        auto push_reserve_counter_ = push_reserve_counter.load(std::memory_order::memory_order_relaxed);
+        auto push_reserve_counter_ = push_reserve_counter.load(std::memory_order_relaxed);
         while(true){
-            if (push_reserve_counter_ - pop_counter.load(std::memory_order::memory_order_acquire) >= capacity_){  //full    //acquaire1
+            if (push_reserve_counter_ - pop_counter.load(std::memory_order_acquire) >= capacity_){  //full    //acquaire1
                 return false;
             }else{
                 auto next_push_reserve_counter = push_reserve_counter_+1;
-                if (push_reserve_counter.compare_exchange_weak(push_reserve_counter_, next_push_reserve_counter, std::memory_order::memory_order_relaxed)){
+                if (push_reserve_counter.compare_exchange_weak(push_reserve_counter_, next_push_reserve_counter, std::memory_order_relaxed)){
                     elements[index(push_reserve_counter_)].emplace(std::forward<Args>(args)...);
-                    while(push_counter.load(std::memory_order::memory_order_acquire) != push_reserve_counter_){ //wait for prev pushes  acquaire0
+                    while(push_counter.load(std::memory_order_acquire) != push_reserve_counter_){ //wait for prev pushes  acquaire0
                         std::this_thread::yield();
                     }
-                    push_counter.store(next_push_reserve_counter, std::memory_order::memory_order_release);     //release0
+                    push_counter.store(next_push_reserve_counter, std::memory_order_release);     //release0
                     return true;
                 }
             }
@@ -355,15 +529,15 @@ public:
     //not return until push is complete
     template<typename...Args>
     void push(Args&&...args){
-        auto push_reserve_counter_ = push_reserve_counter.fetch_add(1, std::memory_order::memory_order_relaxed);   //leads to overwrite
-        while(push_reserve_counter_ - pop_counter.load(std::memory_order::memory_order_acquire) >= capacity_){ //wait until not full
+        auto push_reserve_counter_ = push_reserve_counter.fetch_add(1, std::memory_order_relaxed);   //leads to overwrite
+        while(push_reserve_counter_ - pop_counter.load(std::memory_order_acquire) >= capacity_){ //wait until not full
             std::this_thread::yield();
         }
         elements[index(push_reserve_counter_)].emplace(std::forward<Args>(args)...);
-        while(push_counter.load(std::memory_order::memory_order_acquire) != push_reserve_counter_){ //wait for prev pushes
+        while(push_counter.load(std::memory_order_acquire) != push_reserve_counter_){ //wait for prev pushes
             std::this_thread::yield();
         }
-        push_counter.store(push_reserve_counter_+1, std::memory_order::memory_order_release); //commit
+        push_counter.store(push_reserve_counter_+1, std::memory_order_release); //commit
     }
 
     //not return until pop is complete
@@ -376,27 +550,61 @@ public:
         return v;
     }
 
-    auto size()const{return push_counter.load(std::memory_order::memory_order_relaxed) - pop_counter.load(std::memory_order::memory_order_relaxed);}
+    //pop up to n elements to range starting at first, not waiting, return number of popped elements
+    //all ready elements are reserved at once and committed with single pop_counter update
+    template<typename It>
+    size_type try_pop_n(It first, size_type n){
+        auto pop_reserve_counter_ = pop_reserve_counter.load(std::memory_order_relaxed);
+        while(true){
+            const auto push_counter_ = push_counter.load(std::memory_order_acquire);
+            if (n == 0 || pop_reserve_counter_ >= push_counter_){   //empty
+                return 0;
+            }else{
+                const auto k = std::min(n, push_counter_ - pop_reserve_counter_);
+                if (pop_reserve_counter.compare_exchange_weak(pop_reserve_counter_, pop_reserve_counter_+k, std::memory_order_relaxed)){
+                    for (size_type i{0}; i!=k; ++i, ++first){
+                        const auto index_ = index(pop_reserve_counter_+i);
+                        elements[index_].move(*first);
+                        elements[index_].destroy();
+                    }
+                    while(pop_counter.load(std::memory_order_acquire) != pop_reserve_counter_){//wait for prev pops
+                        std::this_thread::yield();
+                    }
+                    pop_counter.store(pop_reserve_counter_+k, std::memory_order_release);
+                    return k;
+                }
+            }
+        }
+    }
+
+    //wait at most timeout for first element, then pop up to n elements like try_pop_n, return number of popped elements
+    //waiting thread polls queue, blocking_queue parks it instead
+    template<typename It, typename Rep, typename Period>
+    size_type pop_n(It first, size_type n, const std::chrono::duration<Rep,Period>& timeout){
+        return detail::pop_n_(*this, first, n, timeout);
+    }
+
+    auto size()const{return push_counter.load(std::memory_order_relaxed) - pop_counter.load(std::memory_order_relaxed);}
     auto capacity()const{return capacity_;}
 
 private:
 
     template<typename V>
     bool try_pop_(V& v){
-        auto pop_reserve_counter_ = pop_reserve_counter.load(std::memory_order::memory_order_relaxed);
+        auto pop_reserve_counter_ = pop_reserve_counter.load(std::memory_order_relaxed);
         while(true){
-            if (pop_reserve_counter_ >= push_counter.load(std::memory_order::memory_order_acquire)){   //empty   //acquaire0
+            if (pop_reserve_counter_ >= push_counter.load(std::memory_order_acquire)){   //empty   //acquaire0
                 return false;
             }else{
                 auto next_pop_reserve_counter = pop_reserve_counter_+1;
-                if (pop_reserve_counter.compare_exchange_weak(pop_reserve_counter_, next_pop_reserve_counter, std::memory_order::memory_order_relaxed)){
+                if (pop_reserve_counter.compare_exchange_weak(pop_reserve_counter_, next_pop_reserve_counter, std::memory_order_relaxed)){
                     const auto index_ = index(pop_reserve_counter_);
                     elements[index_].move(v);
                     elements[index_].destroy();
-                    while(pop_counter.load(std::memory_order::memory_order_acquire) != pop_reserve_counter_){//wait for prev pops  acquaire1
+                    while(pop_counter.load(std::memory_order_acquire) != pop_reserve_counter_){//wait for prev pops  acquaire1
                         std::this_thread::yield();
                     }
-                    pop_counter.store(next_pop_reserve_counter, std::memory_order::memory_order_release);   //release1
+                    pop_counter.store(next_pop_reserve_counter, std::memory_order_release);   //release1
                     return true;
                 }
             }
@@ -405,22 +613,22 @@ private:
 
     template<typename V>
     void pop_(V& v){
-        auto pop_reserve_counter_ = pop_reserve_counter.fetch_add(1, std::memory_order::memory_order_relaxed);
-        while(pop_reserve_counter_ >= push_counter.load(std::memory_order::memory_order_acquire)){ //wait until not empty
+        auto pop_reserve_counter_ = pop_reserve_counter.fetch_add(1, std::memory_order_relaxed);
+        while(pop_reserve_counter_ >= push_counter.load(std::memory_order_acquire)){ //wait until not empty
             std::this_thread::yield();
         }
         const auto index_ = index(pop_reserve_counter_);
         elements[index_].move(v);
         elements[index_].destroy();
-        while(pop_counter.load(std::memory_order::memory_order_acquire) != pop_reserve_counter_){ //wait for prev pops
+        while(pop_counter.load(std::memory_order_acquire) != pop_reserve_counter_){ //wait for prev pops
             std::this_thread::yield();
         }
-        pop_counter.store(pop_reserve_counter_+1, std::memory_order::memory_order_release);    //commit
+        pop_counter.store(pop_reserve_counter_+1, std::memory_order_release);    //commit
     }
 
     void clear(){
-        auto pop_reserve_counter_ = pop_reserve_counter.load(std::memory_order::memory_order_relaxed);
-        auto push_counter_ = push_counter.load(std::memory_order::memory_order_relaxed);
+        auto pop_reserve_counter_ = pop_reserve_counter.load(std::memory_order_relaxed);
+        auto push_counter_ = push_counter.load(std::memory_order_relaxed);
         while(push_counter_ != pop_reserve_counter_){
             elements[index(pop_reserve_counter_)].destroy();
             ++pop_reserve_counter_;
@@ -475,14 +683,14 @@ public:
     template<typename...Args>
     bool try_push(Args&&...args){
         std::unique_lock<mutex_type> lock{push_guard};
-        auto push_index_ = push_index.load(std::memory_order::memory_order_relaxed);
+        auto push_index_ = push_index.load(std::memory_order_relaxed);
         auto next_push_index = index(push_index_+1);
-        if (next_push_index == pop_index.load(std::memory_order::memory_order_acquire)){//queue is full
+        if (next_push_index == pop_index.load(std::memory_order_acquire)){//queue is full
             lock.unlock();
             return false;
         }else{
             elements[push_index_].emplace(std::forward<Args>(args)...);
-            push_index.store(next_push_index, std::memory_order::memory_order_release);
+            push_index.store(next_push_index, std::memory_order_release);
             lock.unlock();
             return true;
         }
@@ -504,11 +712,11 @@ public:
     template<typename...Args>
     void push(Args&&...args){
         std::unique_lock<mutex_type> lock{push_guard};
-        auto push_index_ = push_index.load(std::memory_order::memory_order_relaxed);
+        auto push_index_ = push_index.load(std::memory_order_relaxed);
         auto next_push_index = index(push_index_+1);
-        while(next_push_index == pop_index.load(std::memory_order::memory_order_acquire));//wait until not full
+        while(next_push_index == pop_index.load(std::memory_order_acquire));//wait until not full
         elements[push_index_].emplace(std::forward<Args>(args)...);
-        push_index.store(next_push_index, std::memory_order::memory_order_release);
+        push_index.store(next_push_index, std::memory_order_release);
         lock.unlock();
     }
 
@@ -523,25 +731,50 @@ public:
     }
 
     auto size()const{
-        auto push_index_ = push_index.load(std::memory_order::memory_order_relaxed);
-        auto pop_index_ = pop_index.load(std::memory_order::memory_order_relaxed);
+        auto push_index_ = push_index.load(std::memory_order_relaxed);
+        auto pop_index_ = pop_index.load(std::memory_order_relaxed);
         return pop_index_ > push_index_ ? (capacity_+1+push_index_-pop_index_) : (push_index_ - pop_index_);
     }
     auto capacity()const{return capacity_;}
 
+    //pop up to n elements to range starting at first, not waiting, return number of popped elements
+    //elements are popped under single pop_guard lock
+    template<typename It>
+    size_type try_pop_n(It first, size_type n){
+        std::unique_lock<mutex_type> lock{pop_guard};
+        auto pop_index_ = pop_index.load(std::memory_order_relaxed);
+        const auto push_index_ = push_index.load(std::memory_order_acquire);
+        size_type k{0};
+        for (; k!=n && pop_index_ != push_index_; ++k, ++first){
+            elements[pop_index_].move(*first);
+            elements[pop_index_].destroy();
+            pop_index_ = index(pop_index_+1);
+        }
+        pop_index.store(pop_index_, std::memory_order_release);
+        lock.unlock();
+        return k;
+    }
+
+    //wait at most timeout for first element, then pop up to n elements like try_pop_n, return number of popped elements
+    //waiting thread polls queue, blocking_queue parks it instead
+    template<typename It, typename Rep, typename Period>
+    size_type pop_n(It first, size_type n, const std::chrono::duration<Rep,Period>& timeout){
+        return detail::pop_n_(*this, first, n, timeout);
+    }
+
 private:
 
     template<typename V>
     bool try_pop_(V& v){
         std::unique_lock<mutex_type> lock{pop_guard};
-        auto pop_index_ = pop_index.load(std::memory_order::memory_order_relaxed);
-        if (pop_index_ == push_index.load(std::memory_order::memory_order_acquire)){//queue is empty
+        auto pop_index_ = pop_index.load(std::memory_order_relaxed);
+        if (pop_index_ == push_index.load(std::memory_order_acquire)){//queue is empty
             lock.unlock();
             return false;
         }else{
             elements[pop_index].move(v);
             elements[pop_index].destroy();
-            pop_index.store(index(pop_index_+1), std::memory_order::memory_order_release);
+            pop_index.store(index(pop_index_+1), std::memory_order_release);
             lock.unlock();
             return true;
         }
@@ -550,17 +783,17 @@ private:
     template<typename V>
     void pop_(V& v){
         std::unique_lock<mutex_type> lock{pop_guard};
-        auto pop_index_ = pop_index.load(std::memory_order::memory_order_relaxed);
-        while(pop_index_ == push_index.load(std::memory_order::memory_order_acquire));//wait until not empty
+        auto pop_index_ = pop_index.load(std::memory_order_relaxed);
+        while(pop_index_ == push_index.load(std::memory_order_acquire));//wait until not empty
         elements[pop_index].move(v);
         elements[pop_index].destroy();
-        pop_index.store(index(pop_index_+1), std::memory_order::memory_order_release);
+        pop_index.store(index(pop_index_+1), std::memory_order_release);
         lock.unlock();
     }
 
     void clear(){
-        auto pop_index_ = pop_index.load(std::memory_order::memory_order_relaxed);
-        auto push_index_ = push_index.load(std::memory_order::memory_order_relaxed);
+        auto pop_index_ = pop_index.load(std::memory_order_relaxed);
+        auto push_index_ = push_index.load(std::memory_order_relaxed);
         while(pop_index_ != push_index_){
             elements[pop_index].destroy();
             pop_index_ = index(pop_index_+1);
@@ -579,126 +812,1646 @@ private:
     mutex_type pop_guard{};
 };
 
-//single thread bounded queue
-template<typename T, typename Allocator = std::allocator<detail::element_<T>>>
-class st_bounded_queue
+//wrapper of mpmc_bounded_queue_v1, v2 or v3 that parks consumers waiting in pop and pop_n instead of polling
+//push notifies has_element eventcount after every successful push, that costs fence per push, so it is opt in
+template<typename Queue>
+class blocking_queue
 {
-    using element_type = typename std::allocator_traits<Allocator>::value_type;
+    using queue_type = Queue;
+public:
+    using value_type = typename queue_type::value_type;
     using size_type = std::size_t;
+
+    blocking_queue(const blocking_queue&) = delete;
+    blocking_queue(blocking_queue&&) = delete;
+    blocking_queue& operator=(const blocking_queue&) = delete;
+    blocking_queue& operator=(blocking_queue&&) = delete;
+    //args are passed to Queue constructor
+    template<typename...Args>
+    explicit blocking_queue(Args&&...args):
+        queue{std::forward<Args>(args)...}
+    {}
+
+    template<typename...Args>
+    bool try_push(Args&&...args){
+        if (queue.try_push(std::forward<Args>(args)...)){
+            has_element.notify_one();
+            return true;
+        }
+        return false;
+    }
+    template<typename...Args>
+    void push(Args&&...args){
+        queue.push(std::forward<Args>(args)...);
+        has_element.notify_one();
+    }
+
+    bool try_pop(value_type& v){return queue.try_pop(v);}
+    auto try_pop(){return queue.try_pop();}
+    //not return until pop is complete, waiting thread is parked
+    void pop(value_type& v){
+        while(!queue.try_pop(v)){
+            auto key = has_element.prepare_wait();
+            if (queue.try_pop(v)){
+                has_element.cancel_wait();
+                return;
+            }
+            has_element.wait(key);
+        }
+    }
+    auto pop(){
+        while(true){
+            if (auto v = queue.try_pop()){
+                return v;
+            }
+            auto key = has_element.prepare_wait();
+            if (auto v = queue.try_pop()){
+                has_element.cancel_wait();
+                return v;
+            }
+            has_element.wait(key);
+        }
+    }
+
+    template<typename It>
+    size_type try_pop_n(It first, size_type n){return queue.try_pop_n(first, n);}
+    //wait at most timeout for first element, waiting thread is parked, then pop up to n elements like try_pop_n, return number of popped elements
+    template<typename It, typename Rep, typename Period>
+    size_type pop_n(It first, size_type n, const std::chrono::duration<Rep,Period>& timeout){
+        return detail::pop_n_(queue, has_element, first, n, timeout);
+    }
+
+    auto size()const{return queue.size();}
+    auto capacity()const{return queue.capacity();}
+
+private:
+    queue_type queue;
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding_;
+    detail::event_count has_element{};
+};
+
+//multiple producer multiple consumer bounded queue with fetch_add tickets in try_push and try_pop, like CRQ of LCRQ
+//each slot has state word: ticket index, safe bit and kind of slot (empty, reserved, full, reading)
+//producer takes ticket and fills slot if slot is empty and its index not ahead of ticket, takes next ticket otherwise
+//consumer takes ticket and pops element if slot has element with the same index, otherwise marks slot so that producer with late ticket fails,
+//producer fails to fill unsafe slot if consumers passed its ticket
+//consumers that find queue empty pull tail up to head, failed push returns ticket if no other ticket was taken after it
+//try_push may report full queue until consumers pass tickets of failed pushes under contention
+//no operation waits for other: producer skips ticket of slot that is being read, consumer marks slot being read unsafe,
+//consumer that finds slot reserved for its ticket moves reservation to next round, element is popped by consumer of that round
+template<typename T, typename Allocator = std::allocator<detail::element_v1_<T>>>
+class mpmc_bounded_queue_v4
+{
+    using element_type = typename std::allocator_traits<Allocator>::value_type;
+    using size_type = typename element_type::size_type;
     static_assert(std::is_unsigned_v<size_type>);
+    //slot kinds
+    static constexpr size_type empty = 0;
+    static constexpr size_type reserved = 1;    //producer constructs element
+    static constexpr size_type full = 2;
+    static constexpr size_type reading = 3;     //consumer moves element
+    static constexpr size_type kind_mask = 3;
+    static constexpr size_type safe_bit = 4;
+    static constexpr size_type index_shift = 3;
 public:
     using value_type = T;
     using allocator_type = Allocator;
 
-    st_bounded_queue(const st_bounded_queue&) = delete;
-    st_bounded_queue(st_bounded_queue&&) = delete;
-    st_bounded_queue& operator=(const st_bounded_queue&) = delete;
-    st_bounded_queue& operator=(st_bounded_queue&&) = delete;
-    st_bounded_queue(size_type capacity__, const allocator_type& alloc = allocator_type()):
+    mpmc_bounded_queue_v4(const mpmc_bounded_queue_v4&) = delete;
+    mpmc_bounded_queue_v4(mpmc_bounded_queue_v4&&) = delete;
+    mpmc_bounded_queue_v4& operator=(const mpmc_bounded_queue_v4&) = delete;
+    mpmc_bounded_queue_v4& operator=(mpmc_bounded_queue_v4&&) = delete;
+    mpmc_bounded_queue_v4(size_type capacity__, const Allocator& allocator__ = Allocator{}):
         capacity_{capacity__},
-        allocator{alloc}
+        allocator{allocator__}
     {
         if (capacity_ == 0){
             throw std::invalid_argument("queue capacity must be > 0");
         }
-        elements = allocator.allocate(capacity_+1);
+        elements = allocator.allocate(capacity_);
+        init();
     }
-    ~st_bounded_queue()
+    ~mpmc_bounded_queue_v4()
     {
         clear();
-        allocator.deallocate(elements, capacity_+1);
+        allocator.deallocate(elements, capacity_);
     }
 
     //if there is empty slot construct element from args in it and return true, return false otherwise
     template<typename...Args>
-    auto try_push(Args&&...args){
-        value_type* res{nullptr};
-        auto next_push_index = index(push_index+1);
-        if (next_push_index==pop_index){
-            return res;
-        }else{
-            elements[push_index].emplace(std::forward<Args>(args)...);
-            res = &elements[push_index].get();
-            push_index = next_push_index;
-            return res;
+    bool try_push(Args&&...args){
+        while(true){
+            auto t = tail.fetch_add(1, std::memory_order_relaxed);
+            auto& element = elements[index(t)];
+            auto state = element.id.load(std::memory_order_acquire);
+            while(true){
+                if (kind(state) == empty && state_index(state) <= t && (is_safe(state) || head.load(std::memory_order_relaxed) <= t)){
+                    if (element.id.compare_exchange_weak(state, make_state(t, safe_bit, reserved), std::memory_order_acquire, std::memory_order_acquire)){
+                        element.emplace(std::forward<Args>(args)...);
+                        element.id.fetch_add(full-reserved, std::memory_order_release);  //consumer may mark slot unsafe while it is reserved
+                        return true;
+                    }
+                }else{
+                    break;
+                }
+            }
+            auto h = head.load(std::memory_order_relaxed);
+            if (h+capacity_ <= t){//queue full, return ticket if possible
+                auto next_t = t+1;
+                tail.compare_exchange_strong(next_t, t, std::memory_order_relaxed);
+                return false;
+            }
         }
     }
 
-    //if there is element, pop and assign it to v and return true, return false otherwise
+    //if there is element to pop assign it to v and return true, return false otherwise
     bool try_pop(value_type& v){
-        return try_pop_(&v);
+        return try_pop_(v);
     }
 
     //like above but return element wrapper that is implicitly convertible to bool to know if element poped
     auto try_pop(){
         detail::element<value_type> v{};
-        try_pop_(&v);
+        try_pop_(v);
         return v;
     }
 
-    //if there is element, pop and return true, return false otherwise
-    bool pop(){
-        return try_pop_(nullptr);
+    //not return until push is complete
+    template<typename...Args>
+    void push(Args&&...args){
+        while(!try_push(std::forward<Args>(args)...)){ //wait until not full
+            std::this_thread::yield();
+        }
     }
 
-    value_type* front(){return front_helper();}
-    const value_type* front()const{return front_helper();}
+    //not return until pop is complete
+    void pop(value_type& v){
+        pop_(v);
+    }
+    auto pop(){
+        detail::element<value_type> v{};
+        pop_(v);
+        return v;
+    }
 
-    bool empty()const{return push_index == pop_index;}
-    size_type size()const{return pop_index > push_index ? (capacity_+1+push_index-pop_index) : (push_index - pop_index);}
-    size_type capacity()const{return capacity_;}
+    auto size()const{
+        auto h = head.load(std::memory_order_relaxed);
+        auto t = tail.load(std::memory_order_relaxed);
+        return t > h ? std::min(t-h, capacity_) : size_type{0};
+    }
+    auto capacity()const{return capacity_;}
 
 private:
 
-    value_type* front_helper()const{
-        return empty() ? nullptr : &elements[pop_index].get();
+    template<typename V>
+    bool try_pop_(V& v){
+        while(true){
+            auto h = head.fetch_add(1, std::memory_order_relaxed);
+            auto& element = elements[index(h)];
+            auto state = element.id.load(std::memory_order_acquire);
+            while(true){
+                const auto idx = state_index(state);
+                const auto kind_ = kind(state);
+                if (idx > h){//slot is ahead of ticket
+                    break;
+                }else if (kind_ == reserved && idx == h){//producer fills slot, move reservation to next round
+                    if (element.id.compare_exchange_weak(state, make_state(h+capacity_, safe_bit&state, reserved), std::memory_order_acquire, std::memory_order_acquire)){
+                        break;
+                    }
+                }else if (kind_ == empty){//mark slot, so producer with this ticket fails
+                    if (element.id.compare_exchange_weak(state, make_state(h+capacity_, safe_bit&state, empty), std::memory_order_acquire, std::memory_order_acquire)){
+                        break;
+                    }
+                }else if (idx == h){//full
+                    if (element.id.compare_exchange_weak(state, make_state(h, safe_bit&state, reading), std::memory_order_acquire, std::memory_order_acquire)){
+                        element.move(v);
+                        element.destroy();
+                        element.id.fetch_add((capacity_<<index_shift)-reading, std::memory_order_release);  //other consumer may mark slot unsafe while it is read
+                        return true;
+                    }
+                }else{//element of previous round is not popped or read yet, mark slot unsafe
+                    if (element.id.compare_exchange_weak(state, state&~safe_bit, std::memory_order_acquire, std::memory_order_acquire)){
+                        break;
+                    }
+                }
+            }
+            if (tail.load(std::memory_order_relaxed) <= h+1){//queue empty, exit
+                fix_state();
+                return false;
+            }
+        }
     }
 
-    //call with nullptr arg will destroy front and update pop_index
-    //call with valid pointer additionaly move element to v
-    //in any case return true if queue no empty false otherwise
     template<typename V>
-    bool try_pop_(V* v){
-        if (empty()){
-            return false;
-        }else{
-            if (v){
-                elements[pop_index].move(*v);   //move construct from elements to v
+    void pop_(V& v){
+        while(!try_pop_(v)){ //wait until not empty
+            std::this_thread::yield();
+        }
+    }
+
+    //consumers move head ahead of tail when queue is empty, pull tail up to head
+    void fix_state(){
+        while(true){
+            auto t = tail.load(std::memory_order_relaxed);
+            auto h = head.load(std::memory_order_relaxed);
+            if (tail.load(std::memory_order_relaxed) != t){
+                continue;
+            }
+            if (h <= t || tail.compare_exchange_strong(t, h, std::memory_order_relaxed)){
+                return;
             }
-            elements[pop_index].destroy();
-            pop_index = index(pop_index+1);
-            return true;
         }
     }
 
     void clear(){
-        while(!empty()){
-            elements[pop_index].destroy();
-            pop_index = index(pop_index+1);
+        for (size_type i{0}; i!=capacity_; ++i){
+            if (kind(elements[i].id.load(std::memory_order_relaxed)) == full){
+                elements[i].destroy();
+            }
         }
     }
 
-    auto index(size_type cnt){return detail::index_(cnt, capacity_+1);}
+    void init(){
+        for (size_type i{0}; i!=capacity_; ++i){
+            elements[i].id.store(make_state(i, safe_bit, empty));
+        }
+    }
+
+    static size_type make_state(size_type idx, size_type safe, size_type kind_){return idx<<index_shift | safe | kind_;}
+    static size_type state_index(size_type state){return state>>index_shift;}
+    static size_type kind(size_type state){return state&kind_mask;}
+    static bool is_safe(size_type state){return state&safe_bit;}
+    auto index(size_type cnt){return detail::index_(cnt, capacity_);}
 
     size_type capacity_;
     allocator_type allocator;
     element_type* elements;
-    size_type push_index{0};
-    size_type pop_index{0};
+    std::atomic<size_type> tail{0};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding_;
+    std::atomic<size_type> head{0};
 };
 
-//single thread queue of polymorphic objects
-//T - pure interface type, must have virtual destructor
-//push parameterized with T implementation type and requires single allocation
-template<typename T, typename Allocator = std::allocator<std::byte>>
-class st_queue_of_polymorphic
+//multiple producer multiple consumer bounded queue with elimination array in front of mpmc_bounded_queue_v1
+//consumer that fails ring counter cas or finds ring empty waits short time in random exchanger slot instead of retrying ring
+//producer that fails ring counter cas and finds waiting consumer in its random slot hands element over slot, not touching ring
+//every slot transition is single cas and no thread waits for other: producer claims waiting slot, constructs element and publishes it,
+//any consumer takes published element from any slot, consumer that leaves slot claimed by producer doesn't wait for element, it is taken later
+//exchange pairs only operations that collide on ring counters or consumer that finds ring empty, uncontended operations use ring in FIFO order,
+//but exchanged element may pass ring element pushed at the same time, i.e. ordering is relaxed FIFO
+template<typename T, typename Allocator = std::allocator<detail::element_v1_<T>>>
+class mpmc_elimination_queue
 {
-    static_assert(std::has_virtual_destructor_v<T>);
+    using queue_type = mpmc_bounded_queue_v1<T, Allocator>;
+    using size_type = std::size_t;
+    //exchanger slot states
+    static constexpr unsigned char empty = 0;
+    static constexpr unsigned char waiting = 1;    //consumer waits for element
+    static constexpr unsigned char busy = 2;    //producer constructs element or consumer takes it
+    static constexpr unsigned char full = 3;    //element is ready to be taken by any consumer
+    //number of checks waiting consumer makes before leaving slot
+    static constexpr size_type spin_limit = 128;
+
+    struct alignas(detail::hardware_destructive_interference_size) exchanger{
+        std::atomic<unsigned char> state{empty};
+        detail::element_<T> element{};
+    };
 
-    struct element
-    {
-        std::size_t buffer_size;
-        T* impl;    //ref to ImplT object specified in push call, object will be deleted through this ref
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    mpmc_elimination_queue(const mpmc_elimination_queue&) = delete;
+    mpmc_elimination_queue(mpmc_elimination_queue&&) = delete;
+    mpmc_elimination_queue& operator=(const mpmc_elimination_queue&) = delete;
+    mpmc_elimination_queue& operator=(mpmc_elimination_queue&&) = delete;
+    mpmc_elimination_queue(size_type capacity__, size_type exchangers_number__ = 4, const Allocator& allocator__ = Allocator{}):
+        queue{capacity__, allocator__},
+        exchangers_number_{exchangers_number__},
+        exchangers{std::make_unique<exchanger[]>(exchangers_number_)}
+    {
+        if (exchangers_number_ == 0){
+            throw std::invalid_argument("exchangers number must be > 0");
+        }
+    }
+    ~mpmc_elimination_queue(){
+        for (size_type i{0}; i!=exchangers_number_; ++i){//published but not taken elements
+            if (exchangers[i].state.load(std::memory_order_acquire) == full){
+                exchangers[i].element.destroy();
+            }
+        }
+    }
+
+    //if there is empty slot or waiting consumer construct element from args and return true, return false otherwise
+    //exchange is tried after failed ring cas
+    template<typename...Args>
+    bool try_push(Args&&...args){
+        return queue.try_push_([&](){return try_exchange(std::forward<Args>(args)...);}, std::forward<Args>(args)...);
+    }
+
+    //if there is element to pop assign it to v and return true, return false otherwise
+    //after failed ring cas or when ring is empty may wait for producer in exchanger slot not longer than spin_limit checks, never waits for claimed slot
+    bool try_pop(value_type& v){
+        return try_pop_(v);
+    }
+
+    //like above but return element wrapper that is implicitly convertible to bool to know if element poped
+    auto try_pop(){
+        detail::element<value_type> v{};
+        try_pop_(v);
+        return v;
+    }
+
+    //not return until push is complete
+    //ring ticket is reserved without cas, so exchange is tried only when ring is empty
+    template<typename...Args>
+    void push(Args&&...args){
+        if (queue.size() != 0 || !try_exchange(std::forward<Args>(args)...)){
+            queue.push(std::forward<Args>(args)...);
+        }
+    }
+
+    //not return until pop is complete
+    void pop(value_type& v){
+        pop_(v);
+    }
+    auto pop(){
+        detail::element<value_type> v{};
+        pop_(v);
+        return v;
+    }
+
+    //ring size plus elements published in exchanger slots
+    auto size()const{
+        auto res = queue.size();
+        for (size_type i{0}; i!=exchangers_number_; ++i){
+            if (exchangers[i].state.load(std::memory_order_relaxed) == full){
+                ++res;
+            }
+        }
+        return res;
+    }
+    auto capacity()const{return queue.capacity();}
+    auto exchangers_number()const{return exchangers_number_;}
+
+private:
+
+    //hand element to consumer waiting in random slot
+    template<typename...Args>
+    bool try_exchange(Args&&...args){
+        auto& exchanger_ = exchangers[detail::random_index(exchangers_number_)];
+        auto state = exchanger_.state.load(std::memory_order_relaxed);
+        if (state == waiting && exchanger_.state.compare_exchange_strong(state, busy, std::memory_order_acquire, std::memory_order_relaxed)){
+            exchanger_.element.emplace(std::forward<Args>(args)...);
+            exchanger_.state.store(full, std::memory_order_release);
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    bool try_pop_(V& v){
+        auto on_contention = [this, &v](){return try_take_any(v) || try_wait(v, true);};
+        if (queue.try_pop_(v, on_contention) || try_take_any(v) || try_wait(v, false)){
+            return true;
+        }
+        return queue.try_pop_(v);
+    }
+
+    //wait for producer in random slot, when ring is empty stop waiting as soon as ring is not empty
+    template<typename V>
+    bool try_wait(V& v, bool contended){
+        auto& exchanger_ = exchangers[detail::random_index(exchangers_number_)];
+        auto state = empty;
+        if (!exchanger_.state.compare_exchange_strong(state, waiting, std::memory_order_relaxed)){//slot is used by other consumer or producer
+            return false;
+        }
+        for (size_type i{0}; i!=spin_limit && (contended || queue.size() == 0); ++i){
+            if (exchanger_.state.load(std::memory_order_relaxed) == full){
+                break;
+            }
+        }
+        state = waiting;
+        if (exchanger_.state.compare_exchange_strong(state, empty, std::memory_order_relaxed)){//left slot
+            return false;
+        }
+        //slot is claimed by producer, take element if it is published, otherwise it is taken later by any consumer
+        return try_take(exchanger_, v);
+    }
+
+    //take published element from slot
+    template<typename V>
+    bool try_take(exchanger& exchanger_, V& v){
+        auto state = full;
+        if (exchanger_.state.compare_exchange_strong(state, busy, std::memory_order_acquire, std::memory_order_relaxed)){
+            exchanger_.element.move(v);
+            exchanger_.element.destroy();
+            exchanger_.state.store(empty, std::memory_order_release);
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    bool try_take_any(V& v){
+        const auto first = detail::random_index(exchangers_number_);
+        for (size_type i{0}; i!=exchangers_number_; ++i){
+            auto& exchanger_ = exchangers[(first+i)%exchangers_number_];
+            if (exchanger_.state.load(std::memory_order_relaxed) == full && try_take(exchanger_, v)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename V>
+    void pop_(V& v){
+        while(!try_pop_(v)){ //wait until not empty
+            std::this_thread::yield();
+        }
+    }
+
+    queue_type queue;
+    size_type exchangers_number_;
+    std::unique_ptr<exchanger[]> exchangers;
+};
+
+//multiple producer multiple consumer bounded LIFO stack
+//elements are stored in preallocated array, free and full slots are linked in two lock free stacks of slot indices
+//stack head is index of top slot and tag that is incremented on every update, to prevent ABA
+//push takes slot from free stack, constructs element and puts slot to full stack, pop does the opposite
+template<typename T, typename Allocator = std::allocator<detail::element_<T>>>
+class mpmc_bounded_stack
+{
+    using element_type = typename std::allocator_traits<Allocator>::value_type;
+    using size_type = std::size_t;
+    using index_type = std::uint32_t;
+    using head_type = std::uint64_t;
+    static constexpr index_type null_index = std::numeric_limits<index_type>::max();
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    mpmc_bounded_stack(const mpmc_bounded_stack&) = delete;
+    mpmc_bounded_stack(mpmc_bounded_stack&&) = delete;
+    mpmc_bounded_stack& operator=(const mpmc_bounded_stack&) = delete;
+    mpmc_bounded_stack& operator=(mpmc_bounded_stack&&) = delete;
+    mpmc_bounded_stack(size_type capacity__, const Allocator& allocator__ = Allocator{}):
+        capacity_{capacity__},
+        allocator{allocator__}
+    {
+        if (capacity_ == 0 || capacity_ >= null_index){
+            throw std::invalid_argument("stack capacity must be > 0 and < 2^32-1");
+        }
+        elements = allocator.allocate(capacity_);
+        next = std::make_unique<std::atomic<index_type>[]>(capacity_);
+        init();
+    }
+    ~mpmc_bounded_stack()
+    {
+        clear();
+        allocator.deallocate(elements, capacity_);
+    }
+
+    //if there is empty slot construct element from args in it and return true, return false otherwise
+    template<typename...Args>
+    bool try_push(Args&&...args){
+        index_type i{};
+        if (pop_index(free_head, i)){
+            elements[i].emplace(std::forward<Args>(args)...);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            push_index(full_head, i);
+            return true;
+        }
+        return false;
+    }
+
+    //if there is element to pop assign it to v and return true, return false otherwise
+    bool try_pop(value_type& v){
+        return try_pop_(v);
+    }
+
+    //like above but return element wrapper that is implicitly convertible to bool to know if element poped
+    auto try_pop(){
+        detail::element<value_type> v{};
+        try_pop_(v);
+        return v;
+    }
+
+    //not return until push is complete
+    template<typename...Args>
+    void push(Args&&...args){
+        while(!try_push(std::forward<Args>(args)...)){ //wait until not full
+            std::this_thread::yield();
+        }
+    }
+
+    //not return until pop is complete
+    void pop(value_type& v){
+        pop_(v);
+    }
+    auto pop(){
+        detail::element<value_type> v{};
+        pop_(v);
+        return v;
+    }
+
+    //all or nothing, if there are n elements pop top n of them with one cas, assign them to range starting from first and return true, return false otherwise
+    template<typename It>
+    bool try_pop_exactly(It first, size_type n){
+        if (n == 0){
+            return true;
+        }
+        index_type i{};
+        index_type last{};
+        if (pop_indexes(full_head, n, i, last)){
+            size_.fetch_sub(n, std::memory_order_relaxed);
+            for (auto j = i;; j = next[j].load(std::memory_order_relaxed),++first){
+                *first = std::move(elements[j].get());
+                elements[j].destroy();
+                if (j == last){
+                    break;
+                }
+            }
+            push_indexes(free_head, i, last);
+            return true;
+        }
+        return false;
+    }
+
+    //not return until n elements are popped at once
+    template<typename It>
+    void pop_exactly(It first, size_type n){
+        while(!try_pop_exactly(first, n)){ //wait until n elements
+            std::this_thread::yield();
+        }
+    }
+
+    auto size()const{return size_.load(std::memory_order_relaxed);}
+    auto capacity()const{return capacity_;}
+
+private:
+
+    template<typename V>
+    bool try_pop_(V& v){
+        index_type i{};
+        if (pop_index(full_head, i)){
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            elements[i].move(v);
+            elements[i].destroy();
+            push_index(free_head, i);
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    void pop_(V& v){
+        while(!try_pop_(v)){ //wait until not empty
+            std::this_thread::yield();
+        }
+    }
+
+    bool pop_index(std::atomic<head_type>& head, index_type& i){
+        auto head_ = head.load(std::memory_order_acquire);
+        while(true){
+            i = top(head_);
+            if (i == null_index){
+                return false;
+            }
+            auto next_ = next[i].load(std::memory_order_relaxed);  //may be stale if slot is popped by other thread, then tag differs and cas fails
+            if (head.compare_exchange_weak(head_, make_head(next_, tag(head_)+1), std::memory_order_acquire, std::memory_order_acquire)){
+                return true;
+            }
+        }
+    }
+
+    //pop chain of n slots, first is top slot, last is bottom one, slots stay linked by next
+    bool pop_indexes(std::atomic<head_type>& head, size_type n, index_type& first, index_type& last){
+        auto head_ = head.load(std::memory_order_acquire);
+        while(true){
+            first = top(head_);
+            last = first;
+            for (size_type k{1}; k<n && last!=null_index; ++k){
+                last = next[last].load(std::memory_order_relaxed);  //may be stale, then tag differs and cas fails
+            }
+            if (last == null_index){
+                if (head.compare_exchange_weak(head_, head_, std::memory_order_acquire, std::memory_order_acquire)){//chain is not stale, less than n slots
+                    return false;
+                }
+                continue;
+            }
+            auto next_ = next[last].load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(head_, make_head(next_, tag(head_)+1), std::memory_order_acquire, std::memory_order_acquire)){
+                return true;
+            }
+        }
+    }
+
+    //push chain of slots linked by next
+    void push_indexes(std::atomic<head_type>& head, index_type first, index_type last){
+        auto head_ = head.load(std::memory_order_relaxed);
+        while(true){
+            next[last].store(top(head_), std::memory_order_relaxed);
+            if (head.compare_exchange_weak(head_, make_head(first, tag(head_)+1), std::memory_order_release, std::memory_order_relaxed)){
+                return;
+            }
+        }
+    }
+
+    void push_index(std::atomic<head_type>& head, index_type i){
+        auto head_ = head.load(std::memory_order_relaxed);
+        while(true){
+            next[i].store(top(head_), std::memory_order_relaxed);
+            if (head.compare_exchange_weak(head_, make_head(i, tag(head_)+1), std::memory_order_release, std::memory_order_relaxed)){
+                return;
+            }
+        }
+    }
+
+    void clear(){
+        index_type i{};
+        while(pop_index(full_head, i)){
+            elements[i].destroy();
+        }
+    }
+
+    void init(){
+        for (size_type i{0}; i!=capacity_; ++i){
+            next[i].store(i+1 == capacity_ ? null_index : static_cast<index_type>(i+1));
+        }
+        free_head.store(make_head(0, 0));
+        full_head.store(make_head(null_index, 0));
+    }
+
+    static head_type make_head(index_type i, head_type tag_){return tag_<<32 | i;}
+    static index_type top(head_type head_){return static_cast<index_type>(head_);}
+    static head_type tag(head_type head_){return head_>>32;}
+
+    size_type capacity_;
+    allocator_type allocator;
+    element_type* elements;
+    std::unique_ptr<std::atomic<index_type>[]> next;
+    std::atomic<head_type> full_head{};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding0_;
+    std::atomic<head_type> free_head{};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding1_;
+    std::atomic<size_type> size_{0};
+};
+
+//multiple producer multiple consumer bounded queue of non null pointers
+//slot is atomic pointer, null marks empty slot, so no sequence word per slot is needed
+//push reserves ticket and stores pointer to empty slot, pop reserves ticket and exchanges slot with null
+//producer that laps slow producer of previous round may fill its slot first, so pointers may be popped not in FIFO order
+//try_pop claims ticket only if its slot is filled, so it doesn't wait for push that reserved ticket but not stored pointer yet,
+//it may wait only for consumer of previous round that claimed the same slot and not emptied it yet
+template<typename T, typename Allocator = std::allocator<std::atomic<T*>>>
+class mpmc_bounded_pointer_queue
+{
+    using element_type = typename std::allocator_traits<Allocator>::value_type;
+    using size_type = std::size_t;
+    static_assert(std::is_same_v<element_type, std::atomic<T*>>);
+public:
+    using value_type = T*;
+    using allocator_type = Allocator;
+
+    mpmc_bounded_pointer_queue(const mpmc_bounded_pointer_queue&) = delete;
+    mpmc_bounded_pointer_queue(mpmc_bounded_pointer_queue&&) = delete;
+    mpmc_bounded_pointer_queue& operator=(const mpmc_bounded_pointer_queue&) = delete;
+    mpmc_bounded_pointer_queue& operator=(mpmc_bounded_pointer_queue&&) = delete;
+    mpmc_bounded_pointer_queue(size_type capacity__, const Allocator& allocator__ = Allocator{}):
+        capacity_{capacity__},
+        allocator{allocator__}
+    {
+        if (capacity_ == 0){
+            throw std::invalid_argument("queue capacity must be > 0");
+        }
+        elements = allocator.allocate(capacity_);
+        for (size_type i{0}; i!=capacity_; ++i){
+            new(elements+i) element_type{nullptr};
+        }
+    }
+    ~mpmc_bounded_pointer_queue()
+    {
+        std::destroy(elements, elements+capacity_);
+        allocator.deallocate(elements, capacity_);
+    }
+
+    //if there is empty slot push p and return true, return false otherwise, p must not be null
+    bool try_push(value_type p){
+        auto push_counter_ = push_counter.load(std::memory_order_relaxed);
+        while(true){
+            if (push_counter_ >= pop_counter.load(std::memory_order_acquire) + capacity_){//full, blocking pops may reserve tickets ahead of push_counter
+                return false;
+            }
+            if (push_counter.compare_exchange_weak(push_counter_, push_counter_+1, std::memory_order_relaxed)){
+                store(elements[index(push_counter_)], p);
+                return true;
+            }
+        }
+    }
+
+    //if there is element to pop assign it to v and return true, return false otherwise
+    bool try_pop(value_type& v){
+        v = try_pop();
+        return v != nullptr;
+    }
+
+    //like above but return popped pointer or nullptr if queue is empty
+    value_type try_pop(){
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
+        while(true){
+            if (pop_counter_ >= push_counter.load(std::memory_order_acquire)){//empty
+                return nullptr;
+            }
+            if (!is_filled(pop_counter_, 1)){//push of ticket is not complete
+                return nullptr;
+            }
+            if (pop_counter.compare_exchange_weak(pop_counter_, pop_counter_+1, std::memory_order_relaxed)){
+                return take(elements[index(pop_counter_)]);
+            }
+        }
+    }
+
+    //not return until push is complete
+    void push(value_type p){
+        auto push_counter_ = push_counter.fetch_add(1, std::memory_order_relaxed); //reserve
+        while(push_counter_ >= pop_counter.load(std::memory_order_acquire) + capacity_){ //wait until not full, consumers may already be ahead of reserved ticket
+            std::this_thread::yield();
+        }
+        store(elements[index(push_counter_)], p);
+    }
+
+    //not return until pop is complete
+    void pop(value_type& v){
+        v = pop();
+    }
+    value_type pop(){
+        auto pop_counter_ = pop_counter.fetch_add(1, std::memory_order_relaxed); //reserve
+        return take(elements[index(pop_counter_)]);
+    }
+
+    //all or nothing, if there are n pointers reserve them with one cas, assign them to range starting from first and return true, return false otherwise
+    template<typename It>
+    bool try_pop_exactly(It first, size_type n){
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
+        while(true){
+            if (pop_counter_ + n > push_counter.load(std::memory_order_acquire)){//less than n pointers
+                return false;
+            }
+            if (!is_filled(pop_counter_, n)){//push of some ticket is not complete
+                return false;
+            }
+            if (pop_counter.compare_exchange_weak(pop_counter_, pop_counter_+n, std::memory_order_relaxed)){
+                take_n(first, pop_counter_, n);
+                return true;
+            }
+        }
+    }
+
+    //reserve n tickets with one fetch_add and not return until n pointers are popped
+    template<typename It>
+    void pop_exactly(It first, size_type n){
+        auto pop_counter_ = pop_counter.fetch_add(n, std::memory_order_relaxed); //reserve
+        take_n(first, pop_counter_, n);
+    }
+
+    auto size()const{
+        auto push_counter_ = push_counter.load(std::memory_order_relaxed);
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
+        return push_counter_ > pop_counter_ ? push_counter_ - pop_counter_ : size_type{0};
+    }
+    auto capacity()const{return capacity_;}
+
+private:
+    //wait until consumer of previous round empties slot
+    static void store(element_type& element, value_type p){
+        value_type expected{nullptr};
+        while(!element.compare_exchange_weak(expected, p, std::memory_order_release, std::memory_order_relaxed)){
+            expected = nullptr;
+            std::this_thread::yield();
+        }
+    }
+    //wait until producer fills slot
+    static value_type take(element_type& element){
+        while(true){
+            if (auto p = element.exchange(nullptr, std::memory_order_acquire)){
+                return p;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    bool is_filled(size_type pop_counter_, size_type n){
+        for (const auto last = pop_counter_+n; pop_counter_!=last; ++pop_counter_){
+            if (elements[index(pop_counter_)].load(std::memory_order_relaxed) == nullptr){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename It>
+    void take_n(It first, size_type pop_counter_, size_type n){
+        for (const auto last = pop_counter_+n; pop_counter_!=last; ++pop_counter_,++first){
+            *first = take(elements[index(pop_counter_)]);
+        }
+    }
+
+    auto index(size_type cnt){return detail::index_(cnt, capacity_);}
+
+    size_type capacity_;
+    allocator_type allocator;
+    element_type* elements;
+    std::atomic<size_type> push_counter{0};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding_;
+    std::atomic<size_type> pop_counter{0};
+};
+
+//bounded work stealing deque of non null pointers (Chase-Lev)
+//owner thread pushes and pops pointers at bottom (LIFO), other threads steal pointers at top (FIFO)
+//owner and thieves race only for last pointer, race is resolved by cas on top
+//capacity is rounded up to power of two
+template<typename T>
+class spmc_bounded_deque
+{
+    using index_type = std::int64_t;
+    using element_type = std::atomic<T*>;
+public:
+    using value_type = T*;
+    using size_type = std::size_t;
+
+    spmc_bounded_deque(const spmc_bounded_deque&) = delete;
+    spmc_bounded_deque(spmc_bounded_deque&&) = delete;
+    spmc_bounded_deque& operator=(const spmc_bounded_deque&) = delete;
+    spmc_bounded_deque& operator=(spmc_bounded_deque&&) = delete;
+    explicit spmc_bounded_deque(size_type capacity__):
+        capacity_{round_capacity(capacity__)},
+        elements{std::make_unique<element_type[]>(capacity_)}
+    {}
+
+    //owner only, return false if deque is full
+    bool try_push(value_type p){
+        const auto b = bottom.load(std::memory_order_relaxed);
+        const auto t = top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<index_type>(capacity_)){//full
+            return false;
+        }
+        elements[index(b)].store(p, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b+1, std::memory_order_relaxed);
+        return true;
+    }
+
+    //owner only, return most recently pushed pointer or nullptr if deque is empty
+    value_type try_pop(){
+        const auto b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);    //pairs with fence in try_steal
+        auto t = top.load(std::memory_order_relaxed);
+        if (t > b){//empty
+            bottom.store(b+1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto p = elements[index(b)].load(std::memory_order_relaxed);
+        if (t == b){//last pointer, race with thieves
+            if (!top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+                p = nullptr;
+            }
+            bottom.store(b+1, std::memory_order_relaxed);
+        }
+        return p;
+    }
+
+    //any thread, return least recently pushed pointer or nullptr if deque is empty or steal lost race
+    value_type try_steal(){
+        auto t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = bottom.load(std::memory_order_acquire);
+        if (t >= b){//empty
+            return nullptr;
+        }
+        auto p = elements[index(t)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+            return nullptr;
+        }
+        return p;
+    }
+
+    auto size()const{
+        const auto b = bottom.load(std::memory_order_relaxed);
+        const auto t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_type>(b - t) : size_type{0};
+    }
+    auto capacity()const{return capacity_;}
+
+private:
+    static size_type round_capacity(size_type capacity__){
+        if (capacity__ == 0){
+            throw std::invalid_argument("deque capacity must be > 0");
+        }
+        size_type res{1};
+        while(res < capacity__){
+            res <<= 1;
+        }
+        return res;
+    }
+    auto index(index_type i)const{return static_cast<size_type>(i) & (capacity_-1);}
+
+    size_type capacity_;
+    std::unique_ptr<element_type[]> elements;
+    std::atomic<index_type> top{0};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding_;
+    std::atomic<index_type> bottom{0};
+};
+
+//multiple producer multiple consumer bounded queue that overwrites oldest elements when full
+//push is lock free and never waits for consumers or other producers, consumers skip overwritten elements and count them
+//each element has sequence number of push with ticket n: 4*n+1 while push is in progress, 4*n+2 when it is complete,
+//4*n+3 if push is abandoned because it lapped older push that is still in progress, 4*n+4 when that older push is done and element is free again
+//abandoned push counts as overwritten, as well as older push it lapped
+//consumer copies element and validates copy rereading sequence number, so T must be trivially copyable
+template<typename T, typename Allocator = std::allocator<detail::element_v1_<T>>>
+class mpmc_overwriting_queue
+{
+    using element_type = typename std::allocator_traits<Allocator>::value_type;
+    using size_type = typename element_type::size_type;
+    static_assert(std::is_unsigned_v<size_type>);
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    mpmc_overwriting_queue(const mpmc_overwriting_queue&) = delete;
+    mpmc_overwriting_queue(mpmc_overwriting_queue&&) = delete;
+    mpmc_overwriting_queue& operator=(const mpmc_overwriting_queue&) = delete;
+    mpmc_overwriting_queue& operator=(mpmc_overwriting_queue&&) = delete;
+    mpmc_overwriting_queue(size_type capacity__, const Allocator& allocator__ = Allocator{}):
+        capacity_{capacity__},
+        allocator{allocator__}
+    {
+        if (capacity_ == 0){
+            throw std::invalid_argument("queue capacity must be > 0");
+        }
+        elements = allocator.allocate(capacity_);
+        init();
+    }
+    ~mpmc_overwriting_queue()
+    {
+        allocator.deallocate(elements, capacity_);
+    }
+
+    //construct element from args, if queue is full oldest element is overwritten
+    //if push laps older push that is still in progress on the same element, that is when producer is preempted while capacity pushes complete,
+    //it is abandoned instead of waiting
+    template<typename...Args>
+    void push(Args&&...args){
+        auto push_counter_ = push_counter.fetch_add(1, std::memory_order_relaxed); //reserve
+        auto& element = elements[index(push_counter_)];
+        const auto in_progress_id = 4*push_counter_+1;
+        auto id = element.id.load(std::memory_order_relaxed);
+        while(true){
+            if (id >= in_progress_id){//element already taken by newer push, this one is overwritten
+                return;
+            }else if (id & 1){//older push in progress, abandon
+                if (element.id.compare_exchange_weak(id, in_progress_id+2, std::memory_order_relaxed)){//id updated when fails
+                    return;
+                }
+            }else if (element.id.compare_exchange_weak(id, in_progress_id, std::memory_order_relaxed)){//id updated when fails
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        element.emplace(std::forward<Args>(args)...);
+        id = in_progress_id;
+        while(!element.id.compare_exchange_weak(id, id == in_progress_id ? in_progress_id+1 : id+1, std::memory_order_release, std::memory_order_relaxed)){
+            //lapped and abandoned by newer push, mark element free, id updated when fails
+        }
+    }
+
+    //if there is element to pop assign it to v and return true, return false otherwise
+    bool try_pop(value_type& v){
+        return try_pop_(v);
+    }
+
+    //like above but return element wrapper that is implicitly convertible to bool to know if element poped
+    auto try_pop(){
+        detail::element<value_type> v{};
+        try_pop_(v);
+        return v;
+    }
+
+    //not return until pop is complete
+    void pop(value_type& v){
+        pop_(v);
+    }
+    auto pop(){
+        detail::element<value_type> v{};
+        pop_(v);
+        return v;
+    }
+
+    auto size()const{
+        auto push_counter_ = push_counter.load(std::memory_order_relaxed);
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
+        return pop_counter_ >= push_counter_ ? size_type{0} : std::min(push_counter_ - pop_counter_, capacity_);
+    }
+    auto capacity()const{return capacity_;}
+    //number of elements overwritten before consumers could pop them
+    auto overwritten()const{return overwritten_counter.load(std::memory_order_relaxed);}
+
+private:
+
+    template<typename V>
+    bool try_pop_(V& v){
+        detail::element_<value_type> copy{};
+        auto pop_counter_ = pop_counter.load(std::memory_order_relaxed);
+        while(true){
+            auto push_counter_ = push_counter.load(std::memory_order_acquire);
+            if (pop_counter_ >= push_counter_){//queue empty, exit
+                return false;
+            }
+            if (push_counter_ - pop_counter_ > capacity_){//elements overwritten, skip to oldest one that may be not
+                auto next_pop_counter = push_counter_ - capacity_;
+                if (pop_counter.compare_exchange_weak(pop_counter_, next_pop_counter, std::memory_order_relaxed)){//pop_counter_ updated when fails
+                    overwritten_counter.fetch_add(next_pop_counter - pop_counter_, std::memory_order_relaxed);
+                    pop_counter_ = next_pop_counter;
+                }
+                continue;
+            }
+            auto& element = elements[index(pop_counter_)];
+            const auto full_id = 4*pop_counter_+2;
+            auto id = element.id.load(std::memory_order_acquire);
+            if (id == full_id){
+                std::memcpy(static_cast<void*>(&copy.get()), static_cast<const void*>(&element.get()), sizeof(value_type));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (element.id.load(std::memory_order_relaxed) != full_id){//overwritten while copying, try again
+                    continue;
+                }
+                if (pop_counter.compare_exchange_weak(pop_counter_, pop_counter_+1, std::memory_order_relaxed)){
+                    v = std::move(copy.get());
+                    return true;
+                }
+            }else if (id < full_id){//push not complete, exit
+                return false;
+            }else{//element overwritten or push abandoned, try next
+                if (pop_counter.compare_exchange_weak(pop_counter_, pop_counter_+1, std::memory_order_relaxed)){
+                    overwritten_counter.fetch_add(1, std::memory_order_relaxed);
+                    ++pop_counter_;
+                }
+            }
+        }
+    }
+
+    template<typename V>
+    void pop_(V& v){
+        while(!try_pop_(v)){ //wait until not empty
+            std::this_thread::yield();
+        }
+    }
+
+    void init(){
+        for (size_type i{0}; i!=capacity_; ++i){
+            elements[i].id.store(0);
+        }
+    }
+
+    auto index(size_type cnt){return detail::index_(cnt, capacity_);}
+
+    size_type capacity_;
+    allocator_type allocator;
+    element_type* elements;
+    std::atomic<size_type> push_counter{0};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding0_;
+    std::atomic<size_type> pop_counter{0};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding1_;
+    std::atomic<size_type> overwritten_counter{0};
+};
+
+//set of member queues of the same type that allows to wait until any member has element
+//producers should push through the set, or call notify() after pushing to member directly, to wake up waiting consumers
+//members are polled in priority order, higher priority first, members of equal priority are polled round robin
+//members must be added before the set is used concurrently
+template<typename Queue>
+class queue_set
+{
+    using queue_type = Queue;
+    struct member{
+        queue_type* queue;
+        std::size_t priority;
+        std::size_t id;
+    };
+    struct group{
+        std::size_t first;
+        std::size_t last;
+    };
+public:
+    using value_type = typename queue_type::value_type;
+    using size_type = std::size_t;
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    queue_set(const queue_set&) = delete;
+    queue_set(queue_set&&) = delete;
+    queue_set& operator=(const queue_set&) = delete;
+    queue_set& operator=(queue_set&&) = delete;
+    queue_set() = default;
+
+    //add member queue, returns member id to use in push and to identify member in pop result
+    size_type add(queue_type& queue, size_type priority = 0){
+        const auto id = queues.size();
+        queues.push_back(&queue);
+        auto it = std::find_if(members.begin(), members.end(), [priority](const auto& m){return m.priority < priority;});
+        members.insert(it, member{&queue, priority, id});
+        groups.clear();
+        for (size_type i{0}; i!=members.size(); ++i){
+            if (groups.empty() || members[groups.back().first].priority != members[i].priority){
+                groups.push_back(group{i,i+1});
+            }else{
+                groups.back().last = i+1;
+            }
+        }
+        cursors = std::make_unique<std::atomic<size_type>[]>(groups.size());
+        return id;
+    }
+
+    //try_push to member with id, notify waiting consumer on success
+    template<typename...Args>
+    bool try_push(size_type id, Args&&...args){
+        if (queues[id]->try_push(std::forward<Args>(args)...)){
+            has_element.notify_one();
+            return true;
+        }else{
+            return false;
+        }
+    }
+    //push to member with id, notify waiting consumer
+    template<typename...Args>
+    void push(size_type id, Args&&...args){
+        queues[id]->push(std::forward<Args>(args)...);
+        has_element.notify_one();
+    }
+    //wake up waiting consumer, should be called after pushing to member directly
+    void notify(){
+        has_element.notify_one();
+    }
+
+    //if any member has element assign it to v and return member id, return npos otherwise
+    size_type try_pop(value_type& v){
+        for (size_type g{0}; g!=groups.size(); ++g){
+            const auto first = groups[g].first;
+            const auto n = groups[g].last - first;
+            const auto start = cursors[g].load(std::memory_order_relaxed);
+            for (size_type i{0}; i!=n; ++i){
+                const auto pos = (start+i)%n;
+                auto& m = members[first+pos];
+                if (m.queue->try_pop(v)){
+                    cursors[g].store(pos+1, std::memory_order_relaxed);  //next poll starts from next member
+                    return m.id;
+                }
+            }
+        }
+        return npos;
+    }
+
+    //blocks until any member has element, assign it to v and return member id
+    size_type pop(value_type& v){
+        while(true){
+            auto id = try_pop(v);
+            if (id != npos){
+                return id;
+            }
+            auto key = has_element.prepare_wait();
+            id = try_pop(v);
+            if (id != npos){
+                has_element.cancel_wait();
+                return id;
+            }
+            has_element.wait(key);
+        }
+    }
+
+    auto size()const{
+        size_type res{0};
+        for (const auto& q : queues){
+            res+=q->size();
+        }
+        return res;
+    }
+    auto members_number()const{return queues.size();}
+
+private:
+    std::vector<queue_type*> queues{};   //by id
+    std::vector<member> members{};  //by priority
+    std::vector<group> groups{};
+    std::unique_ptr<std::atomic<size_type>[]> cursors{};
+    detail::event_count has_element{};
+};
+
+//channel with close semantics built on mpmc_bounded_queue_v2
+//capacity > 0 makes buffered channel, send blocks while channel is full
+//capacity == 0 makes rendezvous channel, send blocks until receiver takes element, senders are serialized
+//close() wakes all blocked senders and receivers, send to closed channel returns false, recv returns remaining elements and then false
+//blocked senders and receivers wait on eventcounts, no polling
+template<typename T, typename Allocator = std::allocator<detail::element_<T>>>
+class channel
+{
+    using queue_type = mpmc_bounded_queue_v2<T, Allocator>;
+    using mutex_type = std::mutex;
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+
+    //input iterator, every increment receives element, equal to end after channel is closed and drained
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type*;
+        using reference = value_type&;
+    private:
+        channel* channel_{nullptr};
+        detail::element<value_type> v{};
+        void recv(){
+            if (!channel_->recv_(v)){
+                channel_ = nullptr;
+            }
+        }
+    public:
+        iterator() = default;
+        explicit iterator(channel* channel__):
+            channel_{channel__}
+        {
+            recv();
+        }
+        reference operator*(){return v.get();}
+        pointer operator->(){return &v.get();}
+        iterator& operator++(){
+            recv();
+            return *this;
+        }
+        bool operator==(const iterator& other)const{return channel_ == other.channel_;}
+        bool operator!=(const iterator& other)const{return !(*this == other);}
+    };
+
+    channel(const channel&) = delete;
+    channel(channel&&) = delete;
+    channel& operator=(const channel&) = delete;
+    channel& operator=(channel&&) = delete;
+    explicit channel(size_type capacity__ = 0, const allocator_type& alloc = allocator_type()):
+        capacity_{capacity__},
+        queue(capacity_ == 0 ? 1 : capacity_, alloc)
+    {}
+
+    //blocks until element constructed from args is sent, returns false if channel is closed
+    template<typename...Args>
+    bool send(Args&&...args){
+        sender_guard guard{*this};
+        if (capacity_ == 0){
+            return send_rendezvous(std::forward<Args>(args)...);
+        }
+        while(true){
+            if (closed()){
+                return false;
+            }
+            if (try_push(std::forward<Args>(args)...)){ //args are not used if push fails
+                return true;
+            }
+            auto key = not_full.prepare_wait();
+            if (closed()){
+                not_full.cancel_wait();
+                return false;
+            }
+            if (try_push(std::forward<Args>(args)...)){
+                not_full.cancel_wait();
+                return true;
+            }
+            not_full.wait(key);
+        }
+    }
+
+    //not blocking, returns false if channel is closed or full
+    //rendezvous channel sends only if there is blocked receiver, no other sender in progress and no element in channel,
+    //it doesn't wait until element is taken, element is received by blocked receiver or next recv
+    template<typename...Args>
+    bool try_send(Args&&...args){
+        sender_guard guard{*this};
+        if (closed()){
+            return false;
+        }
+        if (capacity_ == 0){
+            std::unique_lock<mutex_type> lock{rendezvous_guard, std::try_to_lock};
+            if (!lock || waiting_receivers.load() == 0 || !try_push(std::forward<Args>(args)...)){
+                return false;
+            }
+            ++sent;
+            return true;
+        }
+        return try_push(std::forward<Args>(args)...);
+    }
+
+    //blocks until element is received and assigned to v, returns false if channel is closed and drained
+    bool recv(value_type& v){
+        return recv_(v);
+    }
+    //like above but return element wrapper that is implicitly convertible to bool
+    auto recv(){
+        detail::element<value_type> v{};
+        recv_(v);
+        return v;
+    }
+
+    //not blocking, returns false if channel is empty
+    bool try_recv(value_type& v){
+        return try_recv_(v);
+    }
+    auto try_recv(){
+        detail::element<value_type> v{};
+        try_recv_(v);
+        return v;
+    }
+
+    //wakes all blocked senders and receivers, elements sent before close can still be received
+    void close(){
+        closed_.store(true);
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+    bool closed()const{return closed_.load();}
+
+    auto begin(){return iterator{this};}
+    auto end(){return iterator{};}
+
+    auto size()const{return queue.size();}
+    auto capacity()const{return capacity_;}
+
+private:
+    //counts senders in progress, so receivers not report closed channel is drained while element may still be pushed
+    class sender_guard
+    {
+        channel& channel_;
+    public:
+        sender_guard(const sender_guard&) = delete;
+        sender_guard& operator=(const sender_guard&) = delete;
+        explicit sender_guard(channel& channel__):
+            channel_{channel__}
+        {
+            channel_.active_senders.fetch_add(1);
+        }
+        ~sender_guard(){
+            channel_.active_senders.fetch_sub(1);
+            if (channel_.closed()){
+                channel_.not_empty.notify_all();
+            }
+        }
+    };
+
+    template<typename...Args>
+    bool try_push(Args&&...args){
+        if (queue.try_push(std::forward<Args>(args)...)){
+            not_empty.notify_one();
+            return true;
+        }
+        return false;
+    }
+
+    template<typename...Args>
+    bool send_rendezvous(Args&&...args){
+        std::unique_lock<mutex_type> lock{rendezvous_guard};
+        if (closed()){
+            return false;
+        }
+        return handoff(std::forward<Args>(args)...);
+    }
+
+    //rendezvous_guard must be locked, queue may hold element of try_send that is not received yet
+    //push element and wait until it is received, if channel is closed before, take element back and return false
+    //elements are counted, element is received when received counter reaches its number
+    template<typename...Args>
+    bool handoff(Args&&...args){
+        while(!try_push(std::forward<Args>(args)...)){  //args are not used if push fails
+            auto key = not_full.prepare_wait();
+            if (closed()){
+                not_full.cancel_wait();
+                return false;
+            }
+            if (try_push(std::forward<Args>(args)...)){
+                not_full.cancel_wait();
+                break;
+            }
+            not_full.wait(key);
+        }
+        const auto number = ++sent;
+        auto is_received = [this,number](){return received.load(std::memory_order_acquire) >= number;};
+        while(true){
+            if (is_received()){
+                return true;
+            }
+            if (closed()){
+                if (queue.try_pop()){   //queue capacity is one, so popped element is this one
+                    --sent;
+                    return false;
+                }
+                return true;    //receiver took element, received counter is incremented by it
+            }
+            auto key = not_full.prepare_wait();
+            if (is_received() || closed()){
+                not_full.cancel_wait();
+                continue;
+            }
+            not_full.wait(key);
+        }
+    }
+
+    template<typename V>
+    bool try_recv_(V& v){
+        if (try_pop_queue(v)){
+            if (capacity_ == 0){
+                received.fetch_add(1, std::memory_order_release);
+            }
+            not_full.notify_one();
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    bool recv_(V& v){
+        while(true){
+            if (try_recv_(v)){
+                return true;
+            }
+            if (closed() && active_senders.load() == 0){
+                return try_recv_(v);
+            }
+            waiting_receivers.fetch_add(1);
+            auto key = not_empty.prepare_wait();
+            if (try_recv_(v)){
+                not_empty.cancel_wait();
+                waiting_receivers.fetch_sub(1);
+                return true;
+            }
+            if (closed() && active_senders.load() == 0){
+                not_empty.cancel_wait();
+                waiting_receivers.fetch_sub(1);
+                return try_recv_(v);
+            }
+            not_empty.wait(key);
+            waiting_receivers.fetch_sub(1);
+        }
+    }
+
+    bool try_pop_queue(value_type& v){return queue.try_pop(v);}
+    bool try_pop_queue(detail::element<value_type>& v){
+        v = queue.try_pop();
+        return static_cast<bool>(v);
+    }
+
+    size_type capacity_;
+    queue_type queue;
+    std::atomic<bool> closed_{false};
+    std::atomic<size_type> active_senders{0};
+    std::atomic<size_type> waiting_receivers{0};
+    std::atomic<size_type> received{0};
+    size_type sent{0};  //guarded by rendezvous_guard
+    mutex_type rendezvous_guard{};
+    detail::event_count not_empty{};
+    detail::event_count not_full{};
+};
+
+//single thread bounded queue
+template<typename T, typename Allocator = std::allocator<detail::element_<T>>>
+class st_bounded_queue
+{
+    using element_type = typename std::allocator_traits<Allocator>::value_type;
+    using size_type = std::size_t;
+    static_assert(std::is_unsigned_v<size_type>);
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    st_bounded_queue(const st_bounded_queue&) = delete;
+    st_bounded_queue(st_bounded_queue&&) = delete;
+    st_bounded_queue& operator=(const st_bounded_queue&) = delete;
+    st_bounded_queue& operator=(st_bounded_queue&&) = delete;
+    st_bounded_queue(size_type capacity__, const allocator_type& alloc = allocator_type()):
+        capacity_{capacity__},
+        allocator{alloc}
+    {
+        if (capacity_ == 0){
+            throw std::invalid_argument("queue capacity must be > 0");
+        }
+        elements = allocator.allocate(capacity_+1);
+    }
+    ~st_bounded_queue()
+    {
+        clear();
+        allocator.deallocate(elements, capacity_+1);
+    }
+
+    //if there is empty slot construct element from args in it and return true, return false otherwise
+    template<typename...Args>
+    auto try_push(Args&&...args){
+        value_type* res{nullptr};
+        auto next_push_index = index(push_index+1);
+        if (next_push_index==pop_index){
+            return res;
+        }else{
+            elements[push_index].emplace(std::forward<Args>(args)...);
+            res = &elements[push_index].get();
+            push_index = next_push_index;
+            return res;
+        }
+    }
+
+    //if there is element, pop and assign it to v and return true, return false otherwise
+    bool try_pop(value_type& v){
+        return try_pop_(&v);
+    }
+
+    //like above but return element wrapper that is implicitly convertible to bool to know if element poped
+    auto try_pop(){
+        detail::element<value_type> v{};
+        try_pop_(&v);
+        return v;
+    }
+
+    //if there is element, pop and return true, return false otherwise
+    bool pop(){
+        return try_pop_(nullptr);
+    }
+
+    //pop up to n elements to range starting at first, not waiting, return number of popped elements
+    template<typename It>
+    size_type try_pop_n(It first, size_type n){
+        size_type k{0};
+        for (; k!=n && !empty(); ++k, ++first){
+            elements[pop_index].move(*first);
+            elements[pop_index].destroy();
+            pop_index = index(pop_index+1);
+        }
+        return k;
+    }
+
+    value_type* front(){return front_helper();}
+    const value_type* front()const{return front_helper();}
+
+    bool empty()const{return push_index == pop_index;}
+    size_type size()const{return pop_index > push_index ? (capacity_+1+push_index-pop_index) : (push_index - pop_index);}
+    size_type capacity()const{return capacity_;}
+
+private:
+
+    value_type* front_helper()const{
+        return empty() ? nullptr : &elements[pop_index].get();
+    }
+
+    //call with nullptr arg will destroy front and update pop_index
+    //call with valid pointer additionaly move element to v
+    //in any case return true if queue no empty false otherwise
+    template<typename V>
+    bool try_pop_(V* v){
+        if (empty()){
+            return false;
+        }else{
+            if (v){
+                elements[pop_index].move(*v);   //move construct from elements to v
+            }
+            elements[pop_index].destroy();
+            pop_index = index(pop_index+1);
+            return true;
+        }
+    }
+
+    void clear(){
+        while(!empty()){
+            elements[pop_index].destroy();
+            pop_index = index(pop_index+1);
+        }
+    }
+
+    auto index(size_type cnt){return detail::index_(cnt, capacity_+1);}
+
+    size_type capacity_;
+    allocator_type allocator;
+    element_type* elements;
+    size_type push_index{0};
+    size_type pop_index{0};
+};
+
+//single thread queue of polymorphic objects
+//T - pure interface type, must have virtual destructor
+//push parameterized with T implementation type and requires single allocation
+template<typename T, typename Allocator = std::allocator<std::byte>>
+class st_queue_of_polymorphic
+{
+    static_assert(std::has_virtual_destructor_v<T>);
+
+    struct element
+    {
+        std::size_t buffer_size;
+        T* impl;    //ref to ImplT object specified in push call, object will be deleted through this ref
         element* prev;
         ~element(){
             impl->~T();   //implementation destruction
@@ -825,6 +2578,175 @@ private:
 };
 
 
+//multiple producer single consumer unbounded queue of polymorphic objects, intrusive Vyukov queue
+//like st_queue_of_polymorphic, element and implementation are placed in single allocation and element embeds link to next element
+//push is single atomic exchange, try_pop must not be called concurrently
+//element is constructed by make<ImplT>(args...) and published by push, so producer can access implementation before consumer gets it
+template<typename T, typename Allocator = std::allocator<std::byte>>
+class mpsc_queue_of_polymorphic
+{
+    static_assert(std::has_virtual_destructor_v<T>);
+
+    struct node
+    {
+        std::atomic<node*> prev{nullptr};   //next pushed node
+    };
+    struct element : node
+    {
+        std::size_t buffer_size;
+        T* impl;    //ref to ImplT object specified in make call, object will be deleted through this ref
+        ~element(){
+            impl->~T();   //implementation destruction
+        }
+        element(const element&) = delete;
+        element& operator=(const element&) = delete;
+        element(element&&) = delete;
+        element& operator=(element&&) = delete;
+        element(std::size_t buffer_size_, T* impl_):
+            buffer_size{buffer_size_},
+            impl{impl_}
+        {}
+    };
+
+    //allocator must be stateless
+    static_assert(typename Allocator::is_always_equal());
+public:
+    using allocator_type = Allocator;
+
+    //owns element that is not in queue, element is destroyed and deallocated when unique_element is destroyed
+    class unique_element
+    {
+        friend class mpsc_queue_of_polymorphic;
+        element* elem{nullptr};
+        void clear(){
+            if (elem){
+                auto buffer_size = elem->buffer_size;
+                elem->~element();   //element destruction
+                allocator_type{}.deallocate(reinterpret_cast<std::byte*>(elem), buffer_size); //deallocate buffer, allocator must be stateless
+                elem = nullptr;
+            }
+        }
+        element* release(){
+            auto res = elem;
+            elem = nullptr;
+            return res;
+        }
+    public:
+        ~unique_element(){
+            clear();
+        }
+        unique_element(const unique_element&) = delete;
+        unique_element& operator=(const unique_element&) = delete;
+        unique_element(unique_element&& other):
+            elem{other.release()}
+        {}
+        unique_element& operator=(unique_element&& other){
+            clear();
+            elem = other.release();
+            return *this;
+        }
+        unique_element() = default;
+        explicit unique_element(element* elem_):
+            elem{elem_}
+        {}
+        auto& get()const{return *elem->impl;}
+        auto operator->()const{return elem->impl;}
+        operator bool()const{return static_cast<bool>(elem);}
+    };
+
+    mpsc_queue_of_polymorphic(const mpsc_queue_of_polymorphic&) = delete;
+    mpsc_queue_of_polymorphic(mpsc_queue_of_polymorphic&&) = delete;
+    mpsc_queue_of_polymorphic& operator=(const mpsc_queue_of_polymorphic&) = delete;
+    mpsc_queue_of_polymorphic& operator=(mpsc_queue_of_polymorphic&&) = delete;
+    ~mpsc_queue_of_polymorphic(){
+        while(try_pop()){};
+    }
+    explicit mpsc_queue_of_polymorphic(allocator_type alloc__ = allocator_type{}):
+        alloc_{alloc__}
+    {}
+
+    //construct element not published to queue
+    //ImplT - T interface implementation type, must be derived from T
+    //args - arguments to construct ImplT
+    template<typename ImplT, typename...Args>
+    auto make(Args&&...args){
+        static_assert(std::is_base_of_v<T,ImplT>);
+        auto impl_buffer_size = alignof(ImplT)+sizeof(ImplT);
+        auto buffer_size = sizeof(element)+impl_buffer_size;
+        auto buffer = alloc_.allocate(buffer_size); //single allocation for element and implementation
+        auto impl_buffer = static_cast<void*>(buffer + sizeof(element));
+        if (auto impl_buffer_aligned = std::align(alignof(ImplT), sizeof(ImplT), impl_buffer ,impl_buffer_size)){
+            ImplT* impl{nullptr};
+            try{
+                impl = new (impl_buffer_aligned) ImplT{std::forward<Args>(args)...};
+            }catch(...){
+                alloc_.deallocate(buffer, buffer_size);
+                throw;
+            }
+            return unique_element{new (buffer) element{buffer_size, impl}};
+        }else{
+            alloc_.deallocate(buffer, buffer_size);
+            throw std::bad_alloc();
+        }
+    }
+
+    //push to tail, can be called concurrently
+    void push(unique_element&& elem){
+        node* new_tail = elem.release();
+        new_tail->prev.store(nullptr, std::memory_order_relaxed);
+        push_node(new_tail);
+    }
+    //construct and push
+    template<typename ImplT, typename...Args>
+    void push(Args&&...args){
+        push(make<ImplT>(std::forward<Args>(args)...));
+    }
+
+    //pop from head, not thread safe
+    //returns RAII wrapper around pointer to interface T, implementation will be deleted through this pointer
+    //may return empty wrapper while push that is in progress blocks elements pushed after it
+    auto try_pop(){
+        auto head = head_;
+        auto next = head->prev.load(std::memory_order_acquire);
+        if (head == &stub_){
+            if (!next){//empty queue
+                return unique_element{};
+            }
+            head_ = next;
+            head = next;
+            next = next->prev.load(std::memory_order_acquire);
+        }
+        if (next){
+            head_ = next;
+            return unique_element{static_cast<element*>(head)};
+        }
+        if (head != tail_.load(std::memory_order_acquire)){//push in progress
+            return unique_element{};
+        }
+        stub_.prev.store(nullptr, std::memory_order_relaxed);
+        push_node(&stub_);  //head is last element, put stub behind it to pop it
+        next = head->prev.load(std::memory_order_acquire);
+        if (next){
+            head_ = next;
+            return unique_element{static_cast<element*>(head)};
+        }
+        return unique_element{};
+    }
+
+private:
+    void push_node(node* new_tail){
+        auto prev_tail = tail_.exchange(new_tail, std::memory_order_acq_rel);
+        prev_tail->prev.store(new_tail, std::memory_order_release);
+    }
+
+    allocator_type alloc_;
+    node stub_{};
+    node* head_{&stub_};
+    std::array<std::byte, detail::hardware_destructive_interference_size> padding_;
+    std::atomic<node*> tail_{&stub_};
+};
+
+
 }   //end of namespace queue
 
 #endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+/*
+* Copyright (c) 2022 Ivan Malezhyk <ivanmzk@gmail.com>
+*
+* Distributed under the Boost Software License, Version 1.0.
+* The full license is in the file LICENSE.txt, distributed with this software.
+*/
+
+#ifndef SPILLING_QUEUE_HPP_
+#define SPILLING_QUEUE_HPP_
+
+#include <string>
+#include <system_error>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "queue.hpp"
+
+namespace queue{
+
+namespace detail{
+
+//append only journal of trivially copyable records in memory mapped file
+//file is created with mkstemp, using file_name as name prefix, so existing file is never truncated, and it is unlinked right after it is created,
+//nothing is left on disk when journal is destroyed or process terminates
+//journal rewinds to the beginning of the file when all records are popped, when full it moves not popped records to the beginning of the file
+//if at least half of it is popped, and grows twice otherwise
+//if grow fails exception is thrown and journal keeps its records and capacity
+//not thread safe
+template<typename T>
+class mapped_journal
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    mapped_journal(const mapped_journal&) = delete;
+    mapped_journal(mapped_journal&&) = delete;
+    mapped_journal& operator=(const mapped_journal&) = delete;
+    mapped_journal& operator=(mapped_journal&&) = delete;
+    mapped_journal(const std::string& file_name, size_type capacity__):
+        capacity_{capacity__}
+    {
+        if (capacity_ == 0){
+            throw std::invalid_argument("journal capacity must be > 0");
+        }
+        std::string name{file_name+".XXXXXX"};
+        fd = ::mkstemp(name.data());
+        if (fd == -1){
+            throw std::system_error(errno, std::generic_category(), "journal open failed");
+        }
+        ::unlink(name.c_str());
+        try{
+            records = map(capacity_);
+        }catch(...){
+            ::close(fd);
+            throw;
+        }
+    }
+    ~mapped_journal()
+    {
+        unmap();
+        ::close(fd);
+    }
+
+    void push(const value_type& v){
+        if (tail == capacity_){
+            if (2*head >= capacity_){
+                compact();
+            }else{
+                grow();
+            }
+        }
+        std::memcpy(records+tail*sizeof(value_type), &v, sizeof(value_type));
+        ++tail;
+    }
+
+    //if there is record, assign it to v and return true, return false otherwise
+    template<typename V>
+    bool try_pop(V& v){
+        if (empty()){
+            return false;
+        }else{
+            element_<value_type> record{};
+            std::memcpy(static_cast<void*>(&record.get()), records+head*sizeof(value_type), sizeof(value_type));
+            v = std::move(record.get());
+            ++head;
+            if (empty()){//rewind
+                head = 0;
+                tail = 0;
+            }
+            return true;
+        }
+    }
+
+    bool empty()const{return head == tail;}
+    size_type size()const{return tail - head;}
+    size_type capacity()const{return capacity_;}
+
+private:
+    //extend file and map it, existing mapping is not touched
+    std::byte* map(size_type capacity__){
+        const auto bytes = capacity__*sizeof(value_type);
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) == -1){
+            throw std::system_error(errno, std::generic_category(), "journal resize failed");
+        }
+        auto p = ::mmap(nullptr, bytes, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED){
+            throw std::system_error(errno, std::generic_category(), "journal mmap failed");
+        }
+        return static_cast<std::byte*>(p);
+    }
+    void unmap(){
+        if (records){
+            ::munmap(records, capacity_*sizeof(value_type));
+            records = nullptr;
+        }
+    }
+    //records are kept in file, so bigger mapping sees them, old mapping is released only when new one is ready
+    void grow(){
+        const auto new_capacity = 2*capacity_;
+        auto new_records = map(new_capacity);
+        unmap();
+        records = new_records;
+        capacity_ = new_capacity;
+    }
+    void compact(){
+        std::memmove(records, records+head*sizeof(value_type), (tail-head)*sizeof(value_type));
+        tail -= head;
+        head = 0;
+    }
+
+    size_type capacity_;
+    int fd{-1};
+    std::byte* records{nullptr};
+    size_type head{0};
+    size_type tail{0};
+};
+
+}   //end of namespace detail
+
+//multiple producer multiple consumer queue that spills elements to memory mapped journal file when in memory queue is full
+//push never waits for consumers, elements of each producer are popped in order they were pushed
+//once queue spills, new elements go to journal until consumers drain in memory elements and then replay all journal records
+//in memory fast path is mpmc_bounded_queue_v1, journal is guarded by mutex and only touched while queue is spilling,
+//so push doesn't wait for consumers but producers and consumers may wait on journal mutex while queue is spilling
+//push throws std::system_error if journal can't grow, element is not pushed in this case
+template<typename T, typename Allocator = std::allocator<detail::element_v1_<T>>>
+class mpmc_spilling_queue
+{
+    using queue_type = mpmc_bounded_queue_v1<T, Allocator>;
+    using journal_type = detail::mapped_journal<T>;
+    using mutex_type = std::mutex;
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+
+    mpmc_spilling_queue(const mpmc_spilling_queue&) = delete;
+    mpmc_spilling_queue(mpmc_spilling_queue&&) = delete;
+    mpmc_spilling_queue& operator=(const mpmc_spilling_queue&) = delete;
+    mpmc_spilling_queue& operator=(mpmc_spilling_queue&&) = delete;
+    //journal_capacity is initial number of records journal file can hold, it grows when needed
+    mpmc_spilling_queue(size_type capacity__, const std::string& journal_file_name, size_type journal_capacity = 1024, const Allocator& allocator__ = Allocator{}):
+        queue{capacity__, allocator__},
+        journal{journal_file_name, journal_capacity}
+    {}
+
+    //construct element from args and push it to in memory queue if it has slot and nothing is spilled, push it to journal otherwise
+    template<typename...Args>
+    void push(Args&&...args){
+        const value_type v{std::forward<Args>(args)...};
+        if (!spilling.load(std::memory_order_acquire) && queue.try_push(v)){
+            return;
+        }
+        std::lock_guard<mutex_type> lock{journal_guard};
+        if (!spilling.load(std::memory_order_relaxed) && queue.try_push(v)){
+            return;
+        }
+        journal.push(v);
+        spilled_size.store(journal.size(), std::memory_order_relaxed);
+        spilling.store(true, std::memory_order_release);
+    }
+
+    //if there is element to pop assign it to v and return true, return false otherwise
+    //journal records are popped only when in memory queue is empty
+    bool try_pop(value_type& v){
+        return try_pop_(v);
+    }
+
+    //like above but return element wrapper that is implicitly convertible to bool to know if element poped
+    auto try_pop(){
+        detail::element<value_type> v{};
+        try_pop_(v);
+        return v;
+    }
+
+    //not return until pop is complete
+    void pop(value_type& v){
+        pop_(v);
+    }
+    auto pop(){
+        detail::element<value_type> v{};
+        pop_(v);
+        return v;
+    }
+
+    auto size()const{return queue.size() + spilled();}
+    auto capacity()const{return queue.capacity();}
+    //number of elements in journal
+    size_type spilled()const{return spilled_size.load(std::memory_order_relaxed);}
+
+private:
+
+    template<typename V>
+    bool try_pop_(V& v){
+        if (try_pop_queue(v)){
+            return true;
+        }
+        if (!spilling.load(std::memory_order_acquire)){
+            return false;
+        }
+        std::lock_guard<mutex_type> lock{journal_guard};
+        if (queue.size() != 0){//in memory elements are older, or push to in memory queue is in progress
+            return try_pop_queue(v);
+        }
+        if (journal.try_pop(v)){
+            spilled_size.store(journal.size(), std::memory_order_relaxed);
+            if (journal.empty()){
+                spilling.store(false, std::memory_order_release);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    void pop_(V& v){
+        while(!try_pop_(v)){ //wait until not empty
+            std::this_thread::yield();
+        }
+    }
+
+    bool try_pop_queue(value_type& v){return queue.try_pop(v);}
+    bool try_pop_queue(detail::element<value_type>& v){
+        v = queue.try_pop();
+        return static_cast<bool>(v);
+    }
+
+    queue_type queue;
+    journal_type journal;
+    std::atomic<bool> spilling{false};
+    std::atomic<size_type> spilled_size{0};
+    mutex_type journal_guard{};
+};
+
+}   //end of namespace queue
+
+#endif
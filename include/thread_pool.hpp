@@ -11,11 +11,22 @@
 #include <type_traits>
 #include <functional>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <tuple>
+#include <utility>
 #include <thread>
 #include <mutex>
 #include <future>
+#include <stdexcept>
 #include <condition_variable>
+#include <atomic>
+#if !defined(__cpp_lib_atomic_wait) && defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "queue.hpp"
 
 namespace thread_pool{
@@ -51,12 +62,219 @@ public:
     }
 };
 
+namespace detail{
+
+//block until 32 bit flag is not equal to old and wake threads blocked on flag
+//atomic wait where available, futex on Linux, otherwise condition variable from table shared by all flags
+#if defined(__cpp_lib_atomic_wait)
+inline void wait_flag(const std::atomic<std::uint32_t>& flag, std::uint32_t old){
+    flag.wait(old, std::memory_order_acquire);
+}
+inline void wake_flag(std::atomic<std::uint32_t>& flag){
+    flag.notify_all();
+}
+#elif defined(__linux__)
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+inline void wait_flag(const std::atomic<std::uint32_t>& flag, std::uint32_t old){
+    syscall(SYS_futex, reinterpret_cast<const std::uint32_t*>(&flag), FUTEX_WAIT_PRIVATE, old, nullptr, nullptr, 0);
+}
+inline void wake_flag(std::atomic<std::uint32_t>& flag){
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&flag), FUTEX_WAKE_PRIVATE, std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+}
+#else
+struct flag_waiters{
+    std::mutex guard{};
+    std::condition_variable changed{};
+};
+inline flag_waiters& get_flag_waiters(const void* flag){
+    static constexpr std::size_t table_size = 16;
+    static std::array<flag_waiters, table_size> table{};
+    return table[std::hash<const void*>{}(flag)%table_size];
+}
+inline void wait_flag(const std::atomic<std::uint32_t>& flag, std::uint32_t old){
+    auto& waiters = get_flag_waiters(&flag);
+    std::unique_lock<std::mutex> lock{waiters.guard};
+    while(flag.load(std::memory_order_acquire) == old){
+        waiters.changed.wait(lock);
+    }
+}
+//flag must be changed before call
+inline void wake_flag(std::atomic<std::uint32_t>& flag){
+    auto& waiters = get_flag_waiters(&flag);
+    {
+        std::lock_guard<std::mutex> lock{waiters.guard};
+    }
+    waiters.changed.notify_all();
+}
+#endif
+
+//shared state of light_promise and light_future, result is stored inline
+//ready flag is 32 bit atomic, waiting thread marks it and blocks on it with wait_flag, so set_ready wakes only if there is waiter
+template<typename R>
+class light_shared_state
+{
+    struct void_result{};
+    using value_type = std::conditional_t<std::is_void_v<R>, void_result, R>;
+    using flag_type = std::uint32_t;
+    //ready flag states
+    static constexpr flag_type not_ready = 0;
+    static constexpr flag_type ready_ = 1;
+    static constexpr flag_type waited = 2;  //not ready and there is waiter
+public:
+    light_shared_state(const light_shared_state&) = delete;
+    light_shared_state(light_shared_state&&) = delete;
+    light_shared_state& operator=(const light_shared_state&) = delete;
+    light_shared_state& operator=(light_shared_state&&) = delete;
+    light_shared_state() = default;
+    ~light_shared_state()
+    {
+        if (is_ready() && !exception){
+            value.destroy();
+        }
+    }
+
+    template<typename...Args>
+    void set_value(Args&&...args){
+        value.emplace(std::forward<Args>(args)...);
+        set_ready();
+    }
+    void set_exception(std::exception_ptr e){
+        exception = std::move(e);
+        set_ready();
+    }
+    bool is_ready()const{return ready.load(std::memory_order_acquire) == ready_;}
+    void wait(){
+        auto state = ready.load(std::memory_order_acquire);
+        while(state != ready_){
+            if (state == waited || ready.compare_exchange_weak(state, waited, std::memory_order_acquire, std::memory_order_acquire)){
+                wait_flag(ready, waited);
+                state = ready.load(std::memory_order_acquire);
+            }
+        }
+    }
+    R get(){
+        wait();
+        if (exception){
+            std::rethrow_exception(exception);
+        }
+        if constexpr(!std::is_void_v<R>){
+            return std::move(value.get());
+        }
+    }
+    void acquire(){refs.fetch_add(1, std::memory_order_relaxed);}
+    //delete state when last owner releases it
+    void release(){
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+            delete this;
+        }
+    }
+
+private:
+    void set_ready(){
+        if (ready.exchange(ready_, std::memory_order_acq_rel) == waited){
+            wake_flag(ready);
+        }
+    }
+
+    std::atomic<flag_type> ready{0};
+    std::atomic<flag_type> refs{1};
+    queue::detail::element_<value_type> value{};
+    std::exception_ptr exception{};
+};
+
+}   //end of namespace detail
+
+template<typename R> class light_promise;
+
+//single consumer future of light_promise, interface is subset of std::future
+template<typename R>
+class light_future
+{
+    using state_type = detail::light_shared_state<R>;
+    friend class light_promise<R>;
+    state_type* state{nullptr};
+    explicit light_future(state_type* state__):
+        state{state__}
+    {}
+public:
+    ~light_future()
+    {
+        reset();
+    }
+    light_future() = default;
+    light_future(const light_future&) = delete;
+    light_future& operator=(const light_future&) = delete;
+    light_future(light_future&& other):
+        state{std::exchange(other.state, nullptr)}
+    {}
+    light_future& operator=(light_future&& other){
+        if (this != &other){
+            reset();
+            state = std::exchange(other.state, nullptr);
+        }
+        return *this;
+    }
+    bool valid()const{return state != nullptr;}
+    void wait()const{state->wait();}
+    //future is not valid after get
+    R get(){
+        std::unique_ptr<state_type, void(*)(state_type*)> state_{std::exchange(state, nullptr), [](state_type* s){s->release();}};
+        return state_->get();
+    }
+private:
+    void reset(){
+        if (state){
+            std::exchange(state, nullptr)->release();
+        }
+    }
+};
+
+//single producer promise, result is stored in shared state that is allocated once and has no mutex and condition variable
+//shared state is heap allocated by promise constructor, it is not embedded in promise or task because future may outlive both
+//like std::promise it sets broken_promise exception if it is destroyed not satisfied
 template<typename R>
+class light_promise
+{
+    using state_type = detail::light_shared_state<R>;
+    state_type* state;
+public:
+    ~light_promise()
+    {
+        if (state){
+            if (!state->is_ready()){
+                state->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+            state->release();
+        }
+    }
+    light_promise():
+        state{new state_type{}}
+    {}
+    light_promise(const light_promise&) = delete;
+    light_promise& operator=(const light_promise&) = delete;
+    light_promise(light_promise&& other)noexcept:
+        state{std::exchange(other.state, nullptr)}
+    {}
+    light_promise& operator=(light_promise&&) = delete;
+
+    //must be called at most once
+    light_future<R> get_future(){
+        state->acquire();
+        return light_future<R>{state};
+    }
+    template<typename...Args>
+    void set_value(Args&&...args){state->set_value(std::forward<Args>(args)...);}
+    void set_exception(std::exception_ptr e){state->set_exception(std::move(e));}
+};
+
+//Future is std::future<R> or light_future<R>
+template<typename R, typename Future = std::future<R>>
 class task_future
 {
     using result_type = R;
+    using future_type = Future;
     bool sync_;
-    std::future<result_type> f;
+    future_type f;
 public:
     ~task_future(){
         if (sync_ && f.valid()){
@@ -66,7 +284,7 @@ public:
     task_future() = default;
     task_future(task_future&&) = default;
     task_future& operator=(task_future&&) = default;
-    task_future(bool sync__, std::future<result_type>&& f_):
+    task_future(bool sync__, future_type&& f_):
         sync_{sync__},
         f{std::move(f_)}
     {}
@@ -113,14 +331,16 @@ public:
     virtual void call() = 0;
 };
 
-template<typename F, typename...Args>
-class task_v3_impl : public task_v3_base
+//Promise is std::promise or light_promise
+template<template<typename> typename Promise, typename F, typename...Args>
+class promise_task_v3_impl : public task_v3_base
 {
     using args_type = decltype(std::make_tuple(std::declval<Args>()...));
     using result_type = std::decay_t<decltype(std::apply(std::declval<F>(),std::declval<args_type>()))>;
+    using promise_type = Promise<result_type>;
     F f;
     args_type args;
-    std::promise<result_type> task_promise;
+    promise_type task_promise;
     void call() override {
             if constexpr(std::is_void_v<result_type>){
                 std::apply(f, std::move(args));
@@ -130,9 +350,9 @@ class task_v3_impl : public task_v3_base
             }
         }
 public:
-    using future_type = task_future<result_type>;
+    using future_type = task_future<result_type, decltype(std::declval<promise_type&>().get_future())>;
     template<typename F_, typename...Args_>
-    task_v3_impl(F_&& f_, Args_&&...args_):
+    promise_task_v3_impl(F_&& f_, Args_&&...args_):
             f{std::forward<F_>(f_)},
             args{std::make_tuple(std::forward<Args_>(args_)...)}
         {}
@@ -141,6 +361,9 @@ public:
         }
 };
 
+template<typename F, typename...Args>
+using task_v3_impl = promise_task_v3_impl<std::promise, F, Args...>;
+
 template<typename F, typename...Args>
 class group_task_v3_impl : public task_v3_base
 {
@@ -161,27 +384,148 @@ public:
     {}
 };
 
-class task_v3
+//called with exception thrown by detached task
+using exception_handler_type = std::function<void(std::exception_ptr)>;
+
+//task without result, exception is passed to handler, it escapes call if handler is empty
+template<typename F, typename...Args>
+class detached_task_v3_impl : public task_v3_base
+{
+    using args_type = decltype(std::make_tuple(std::declval<Args>()...));
+    std::reference_wrapper<const exception_handler_type> handler_;
+    F f;
+    args_type args;
+    void call() override {
+        try{
+            std::apply(f, std::move(args));
+        }catch(...){
+            if (!handler_.get()){
+                throw;
+            }
+            handler_.get()(std::current_exception());
+        }
+    }
+public:
+    template<typename F_, typename...Args_>
+    detached_task_v3_impl(std::reference_wrapper<const exception_handler_type> handler__, F_&& f_, Args_&&...args_):
+        handler_{handler__},
+        f{std::forward<F_>(f_)},
+        args{std::make_tuple(std::forward<Args_>(args_)...)}
+    {}
+};
+
+//exception handler of thread pool detached tasks, queued tasks refer to it, so it is given to pool constructor and never replaced
+//if handler is empty exception escapes worker and terminates program
+class detached_exception_handler
 {
-    std::unique_ptr<task_v3_base> impl;
+    const exception_handler_type handler;
+protected:
+    explicit detached_exception_handler(exception_handler_type handler_):
+        handler{std::move(handler_)}
+    {}
+    //called by push of detached task
+    const exception_handler_type& exception_handler()const{return handler;}
+};
+
+//task with inline storage, task implementation is constructed in buffer if it fits and is nothrow move constructible, on heap otherwise
+//buffer_size 96 is enough for task_v3_impl of lambda that captures 48 bytes, or group_task_v3_impl of lambda that captures 64 bytes
+//inline task is relocated by move construction when task is moved
+template<std::size_t BufferSize = 96>
+class basic_task_v3
+{
+    using relocate_type = task_v3_base*(*)(task_v3_base*, void*)noexcept;
+    template<typename Impl>
+    static constexpr bool is_inline_v = sizeof(Impl) <= BufferSize && alignof(Impl) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Impl>;
+
+    alignas(std::max_align_t) std::array<std::byte, BufferSize> buffer;
+    task_v3_base* impl{nullptr};
+    relocate_type relocate{nullptr};    //nullptr if impl is on heap
 public:
-    task_v3() = default;
+    static constexpr std::size_t buffer_size = BufferSize;
+
+    ~basic_task_v3()
+    {
+        reset();
+    }
+    basic_task_v3() = default;
+    basic_task_v3(const basic_task_v3&) = delete;
+    basic_task_v3& operator=(const basic_task_v3&) = delete;
+    basic_task_v3(basic_task_v3&& other)noexcept
+    {
+        take(other);
+    }
+    basic_task_v3& operator=(basic_task_v3&& other)noexcept{
+        if (this != &other){
+            reset();
+            take(other);
+        }
+        return *this;
+    }
     void call(){
         impl->call();
     }
-    template<typename F, typename...Args>
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
     auto set_task(bool sync, F&& f, Args&&...args){
-        using impl_type = task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
-        impl = std::make_unique<impl_type>(std::forward<F>(f),std::forward<Args>(args)...);
-        return static_cast<impl_type*>(impl.get())->get_future(sync);
+        using impl_type = promise_task_v3_impl<Promise, std::decay_t<F>, std::decay_t<Args>...>;
+        return emplace<impl_type>(std::forward<F>(f),std::forward<Args>(args)...)->get_future(sync);
     }
     template<typename F, typename...Args>
     void set_group_task(std::reference_wrapper<task_group> group, F&& f, Args&&...args){
         using impl_type = group_task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
-        impl = std::make_unique<impl_type>(group, std::forward<F>(f),std::forward<Args>(args)...);
+        emplace<impl_type>(group, std::forward<F>(f),std::forward<Args>(args)...);
+    }
+    template<typename F, typename...Args>
+    void set_detached_task(const exception_handler_type& handler, F&& f, Args&&...args){
+        using impl_type = detached_task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
+        emplace<impl_type>(std::cref(handler), std::forward<F>(f),std::forward<Args>(args)...);
+    }
+    //true if task implementation is in inline buffer
+    bool is_inline()const{return relocate != nullptr;}
+
+private:
+    template<typename Impl, typename...Args>
+    Impl* emplace(Args&&...args){
+        reset();
+        Impl* p{nullptr};
+        if constexpr (is_inline_v<Impl>){
+            p = new(buffer.data()) Impl(std::forward<Args>(args)...);
+            relocate = &relocate_<Impl>;
+        }else{
+            p = new Impl(std::forward<Args>(args)...);
+        }
+        impl = p;
+        return p;
+    }
+    template<typename Impl>
+    static task_v3_base* relocate_(task_v3_base* from, void* to)noexcept{
+        auto from_ = static_cast<Impl*>(from);
+        auto res = new(to) Impl(std::move(*from_));
+        from_->~Impl();
+        return res;
+    }
+    void take(basic_task_v3& other)noexcept{
+        if (other.impl){
+            impl = other.is_inline() ? other.relocate(other.impl, buffer.data()) : other.impl;
+            relocate = other.relocate;
+            other.impl = nullptr;
+            other.relocate = nullptr;
+        }
+    }
+    void reset(){
+        if (impl){
+            if (is_inline()){
+                impl->~task_v3_base();
+            }else{
+                delete impl;
+            }
+            impl = nullptr;
+            relocate = nullptr;
+        }
     }
 };
 
+using task_v3 = basic_task_v3<>;
+
 
 //allocation free thread pool with bounded task queue
 //has fixed signature and return type of task callable function, only function pointer supported
@@ -340,7 +684,7 @@ private:
 //push template method returns task_future<R>, where R is return type of callable given arguments types
 //push_async template method returns future as above that will not sync on destroy
 //push_group template method bound task to group object to be waited on
-class thread_pool_v3
+class thread_pool_v3 : public detached_exception_handler
 {
     using task_type = task_v3;
     using queue_type = queue::st_bounded_queue<task_type>;
@@ -355,7 +699,11 @@ public:
     thread_pool_v3(std::size_t n_workers):
         thread_pool_v3(n_workers, n_workers)
     {}
-    thread_pool_v3(std::size_t n_workers, std::size_t n_tasks):
+    thread_pool_v3(std::size_t n_workers, exception_handler_type handler_):
+        thread_pool_v3(n_workers, n_workers, std::move(handler_))
+    {}
+    thread_pool_v3(std::size_t n_workers, std::size_t n_tasks, exception_handler_type handler_ = exception_handler_type{}):
+        detached_exception_handler{std::move(handler_)},
         workers(n_workers),
         tasks(n_tasks)
     {
@@ -364,11 +712,12 @@ public:
 
     //return task_future<R> object, where R is return type of F called with args, future will sync when destroyed
     //std::reference_wrapper should be used to pass args by ref
-    template<typename F, typename...Args>
-    auto push(F&& f, Args&&...args){return push_<true>(std::forward<F>(f), std::forward<Args>(args)...);}
+    //Promise may be light_promise to have task_future without std::promise shared state
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push(F&& f, Args&&...args){return push_<true, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
     //returned future will not sync when destroyed
-    template<typename F, typename...Args>
-    auto push_async(F&& f, Args&&...args){return push_<false>(std::forward<F>(f), std::forward<Args>(args)...);}
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push_async(F&& f, Args&&...args){return push_<false, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
     //bind task to group
     template<typename F, typename...Args>
     void push_group(task_group& group, F&& f, Args&&...args){
@@ -385,16 +734,42 @@ public:
             }
         }
     }
+    //task has no future, exception thrown by task is passed to exception handler
+    template<typename F, typename...Args>
+    void push_detached(F&& f, Args&&...args){
+        std::unique_lock<mutex_type> lock{guard};
+        while(true){
+            if (auto task = tasks.try_push()){
+                task->set_detached_task(exception_handler(), std::forward<F>(f), std::forward<Args>(args)...);
+                has_task.notify_one();
+                lock.unlock();
+                break;
+            }else{
+                has_slot.wait(lock);
+            }
+        }
+    }
+    //like above but not blocking, returns false if task queue is full
+    template<typename F, typename...Args>
+    bool try_push_detached(F&& f, Args&&...args){
+        std::unique_lock<mutex_type> lock{guard};
+        if (auto task = tasks.try_push()){
+            task->set_detached_task(exception_handler(), std::forward<F>(f), std::forward<Args>(args)...);
+            has_task.notify_one();
+            return true;
+        }
+        return false;
+    }
 
 private:
 
-    template<bool Sync = true, typename F, typename...Args>
+    template<bool Sync, template<typename> typename Promise, typename F, typename...Args>
     auto push_(F&& f, Args&&...args){
-        using future_type = decltype( std::declval<task_type>().set_task(Sync, std::forward<F>(f), std::forward<Args>(args)...));
+        using future_type = decltype( std::declval<task_type>().template set_task<Promise>(Sync, std::forward<F>(f), std::forward<Args>(args)...));
         std::unique_lock<mutex_type> lock{guard};
         while(true){
             if (auto task = tasks.try_push()){
-                future_type future = task->set_task(Sync, std::forward<F>(f), std::forward<Args>(args)...);
+                future_type future = task->template set_task<Promise>(Sync, std::forward<F>(f), std::forward<Args>(args)...);
                 has_task.notify_one();
                 lock.unlock();
                 return future;
@@ -442,11 +817,13 @@ private:
 
 
 //single allocation thread pool with unbounded task queue
-class thread_pool_v4
+//tasks are pushed to intrusive mpsc queue with single atomic exchange, workers pop tasks under pop_guard and wait on eventcount
+class thread_pool_v4 : public detached_exception_handler
 {
     using task_base_type = task_v3_base;
-    using queue_type = queue::st_queue_of_polymorphic<task_base_type>;
+    using queue_type = queue::mpsc_queue_of_polymorphic<task_base_type>;
     using mutex_type = std::mutex;
+    using event_count_type = queue::detail::event_count;
 
 public:
 
@@ -454,7 +831,8 @@ public:
     {
         stop();
     }
-    thread_pool_v4(std::size_t n_workers):
+    thread_pool_v4(std::size_t n_workers, exception_handler_type handler_ = exception_handler_type{}):
+        detached_exception_handler{std::move(handler_)},
         workers(n_workers)
     {
         init();
@@ -462,33 +840,39 @@ public:
 
     //return task_future<R> object, where R is return type of F called with args, future will sync when destroyed
     //std::reference_wrapper should be used to pass args by ref
-    template<typename F, typename...Args>
-    auto push(F&& f, Args&&...args){return push_<true>(std::forward<F>(f), std::forward<Args>(args)...);}
+    //Promise may be light_promise to have task_future without std::promise shared state
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push(F&& f, Args&&...args){return push_<true, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
     //returned future will not sync when destroyed
-    template<typename F, typename...Args>
-    auto push_async(F&& f, Args&&...args){return push_<false>(std::forward<F>(f), std::forward<Args>(args)...);}
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push_async(F&& f, Args&&...args){return push_<false, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
     //bind task to group
     template<typename F, typename...Args>
     void push_group(task_group& group, F&& f, Args&&...args){
         using task_impl_type = group_task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
-        std::unique_lock<mutex_type> lock{guard};
-        tasks.push<task_impl_type>(std::ref(group), std::forward<F>(f), std::forward<Args>(args)...);
+        auto task = tasks.make<task_impl_type>(std::ref(group), std::forward<F>(f), std::forward<Args>(args)...);
         group.inc();
+        tasks.push(std::move(task));
+        has_task.notify_one();
+    }
+    //task has no future, exception thrown by task is passed to exception handler
+    template<typename F, typename...Args>
+    void push_detached(F&& f, Args&&...args){
+        using task_impl_type = detached_task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
+        tasks.push(tasks.make<task_impl_type>(std::cref(exception_handler()), std::forward<F>(f), std::forward<Args>(args)...));
         has_task.notify_one();
-        lock.unlock();
     }
 
 private:
 
-    template<bool Sync = true, typename F, typename...Args>
+    template<bool Sync, template<typename> typename Promise, typename F, typename...Args>
     auto push_(F&& f, Args&&...args){
-        using task_impl_type = task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
+        using task_impl_type = promise_task_v3_impl<Promise, std::decay_t<F>, std::decay_t<Args>...>;
         using future_type = typename task_impl_type::future_type;
-        std::unique_lock<mutex_type> lock{guard};
-        auto task = tasks.push<task_impl_type>(std::forward<F>(f), std::forward<Args>(args)...);
-        future_type future = task->get_future(Sync);
+        auto task = tasks.make<task_impl_type>(std::forward<F>(f), std::forward<Args>(args)...);
+        future_type future = static_cast<task_impl_type&>(task.get()).get_future(Sync);  //task may be complete and destroyed right after push
+        tasks.push(std::move(task));
         has_task.notify_one();
-        lock.unlock();
         return future;
     }
 
@@ -497,33 +881,342 @@ private:
     }
 
     void stop(){
-        std::unique_lock<mutex_type> lock{guard};
         finish_workers.store(true);
         has_task.notify_all();
-        lock.unlock();
         std::for_each(workers.begin(),workers.end(),[](auto& worker){worker.join();});
     }
 
+    auto try_pop(){
+        std::lock_guard<mutex_type> lock{pop_guard};
+        return tasks.try_pop();
+    }
+
     void worker_loop(){
         while(!finish_workers.load()){  //worker loop
-            std::unique_lock<mutex_type> lock{guard};
-            while(!finish_workers.load()){  //has_task conditional loop
-                if (auto t = tasks.try_pop()){
-                    lock.unlock();
-                    t->call();
-                    break;
-                }else{
-                    has_task.wait(lock);
-                }
+            if (auto t = try_pop()){
+                t->call();
+                continue;
+            }
+            auto key = has_task.prepare_wait();
+            if (finish_workers.load()){
+                has_task.cancel_wait();
+                break;
             }
+            if (auto t = try_pop()){
+                has_task.cancel_wait();
+                t->call();
+                continue;
+            }
+            has_task.wait(key);
         }
     }
 
     std::vector<std::thread> workers;
     queue_type tasks{};
     std::atomic<bool> finish_workers{false};
-    mutex_type guard;
-    std::condition_variable has_task;
+    mutex_type pop_guard;
+    event_count_type has_task;
+};
+
+//work stealing thread pool
+//each worker has lock free work stealing deque, task pushed from worker thread goes to bottom of its deque and is executed in LIFO order
+//task pushed from other thread goes to injection queue, when own deque is empty worker pops injection queue, then steals from top of deque of random worker
+//idle workers wait on eventcount, every push notifies one of them
+//deque_capacity is capacity of each worker's deque, task pushed from worker goes to injection queue if deque is full
+//n_tasks is capacity of injection queue, push from other thread waits while injection queue is full
+class thread_pool_v5 : public detached_exception_handler
+{
+    using task_base_type = task_v3_base;
+    using deque_type = queue::spmc_bounded_deque<task_base_type>;
+    using queue_type = queue::mpmc_bounded_pointer_queue<task_base_type>;
+    using event_count_type = queue::detail::event_count;
+
+    //worker of current thread
+    struct worker_context{
+        const thread_pool_v5* pool;
+        std::size_t index;
+    };
+    inline static thread_local worker_context context{nullptr, 0};
+
+public:
+
+    ~thread_pool_v5()
+    {
+        stop();
+    }
+    thread_pool_v5(std::size_t n_workers):
+        thread_pool_v5(n_workers, 1024, 1024)
+    {}
+    thread_pool_v5(std::size_t n_workers, exception_handler_type handler_):
+        thread_pool_v5(n_workers, 1024, 1024, std::move(handler_))
+    {}
+    thread_pool_v5(std::size_t n_workers, std::size_t n_tasks, std::size_t deque_capacity = 1024, exception_handler_type handler_ = exception_handler_type{}):
+        detached_exception_handler{std::move(handler_)},
+        workers(n_workers),
+        injection(n_tasks)
+    {
+        deques.reserve(n_workers);
+        for (std::size_t i{0}; i!=n_workers; ++i){
+            deques.push_back(std::make_unique<deque_type>(deque_capacity));
+        }
+        init();
+    }
+
+    //return task_future<R> object, where R is return type of F called with args, future will sync when destroyed
+    //std::reference_wrapper should be used to pass args by ref
+    //Promise may be light_promise to have task_future without std::promise shared state
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push(F&& f, Args&&...args){return push_<true, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
+    //returned future will not sync when destroyed
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push_async(F&& f, Args&&...args){return push_<false, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
+    //bind task to group
+    template<typename F, typename...Args>
+    void push_group(task_group& group, F&& f, Args&&...args){
+        using task_impl_type = group_task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
+        auto task = std::make_unique<task_impl_type>(std::ref(group), std::forward<F>(f), std::forward<Args>(args)...);
+        group.inc();
+        push_task(task.release());
+    }
+    //task has no future, exception thrown by task is passed to exception handler
+    template<typename F, typename...Args>
+    void push_detached(F&& f, Args&&...args){
+        using task_impl_type = detached_task_v3_impl<std::decay_t<F>, std::decay_t<Args>...>;
+        push_task(std::make_unique<task_impl_type>(std::cref(exception_handler()), std::forward<F>(f), std::forward<Args>(args)...).release());
+    }
+
+private:
+
+    template<bool Sync, template<typename> typename Promise, typename F, typename...Args>
+    auto push_(F&& f, Args&&...args){
+        using task_impl_type = promise_task_v3_impl<Promise, std::decay_t<F>, std::decay_t<Args>...>;
+        auto task = std::make_unique<task_impl_type>(std::forward<F>(f), std::forward<Args>(args)...);
+        auto future = task->get_future(Sync);   //task may be complete and destroyed right after push
+        push_task(task.release());
+        return future;
+    }
+
+    //task pushed from worker is called in place if both its deque and injection queue are full, so workers never wait for each other
+    void push_task(task_base_type* task){
+        if (context.pool == this){
+            if (!deques[context.index]->try_push(task) && !injection.try_push(task)){
+                call(task);
+                return;
+            }
+        }else{
+            injection.push(task);
+        }
+        has_task.notify_one();
+    }
+
+    void init(){
+        for (std::size_t i{0}; i!=workers.size(); ++i){
+            workers[i] = std::thread{&thread_pool_v5::worker_loop, this, i};
+        }
+    }
+
+    void stop(){
+        finish_workers.store(true);
+        has_task.notify_all();
+        std::for_each(workers.begin(),workers.end(),[](auto& worker){worker.join();});
+        //not executed tasks
+        std::for_each(deques.begin(),deques.end(),[](auto& deque){
+            while(auto t = deque->try_steal()){
+                delete t;
+            }
+        });
+        while(auto t = injection.try_pop()){
+            delete t;
+        }
+    }
+
+    //own deque, then injection queue, then deques of other workers starting from random one
+    task_base_type* try_pop(std::size_t index){
+        if (auto t = deques[index]->try_pop()){
+            return t;
+        }
+        if (auto t = injection.try_pop()){
+            return t;
+        }
+        const auto n = deques.size();
+        const auto first = queue::detail::random_index(n);
+        for (std::size_t i{0}; i!=n; ++i){
+            const auto victim = (first+i)%n;
+            if (victim != index){
+                if (auto t = deques[victim]->try_steal()){
+                    return t;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void call(task_base_type* task){
+        std::unique_ptr<task_base_type> task_{task};
+        task_->call();
+    }
+
+    void worker_loop(std::size_t index){
+        context = worker_context{this, index};
+        while(!finish_workers.load()){  //worker loop
+            if (auto t = try_pop(index)){
+                call(t);
+                continue;
+            }
+            auto key = has_task.prepare_wait();
+            if (finish_workers.load()){
+                has_task.cancel_wait();
+                break;
+            }
+            if (auto t = try_pop(index)){
+                has_task.cancel_wait();
+                call(t);
+                continue;
+            }
+            has_task.wait(key);
+        }
+        context = worker_context{nullptr, 0};
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<deque_type>> deques{};
+    queue_type injection;
+    std::atomic<bool> finish_workers{false};
+    event_count_type has_task;
+};
+
+//single allocation thread pool with bounded lock free task queue
+//like thread_pool_v3 but tasks are pushed to and popped from mpmc_bounded_queue_v1 of task_v3 without lock
+//idle workers wait on has_task eventcount, pushers wait on has_slot eventcount when queue is full
+//eventcount mutex is locked only when there are waiters, so not contended push and pop touch only queue counters
+class thread_pool_v6 : public detached_exception_handler
+{
+    using task_type = task_v3;
+    using queue_type = queue::mpmc_bounded_queue_v1<task_type>;
+    using event_count_type = queue::detail::event_count;
+
+public:
+
+    ~thread_pool_v6()
+    {
+        stop();
+    }
+    thread_pool_v6(std::size_t n_workers):
+        thread_pool_v6(n_workers, 1024)
+    {}
+    thread_pool_v6(std::size_t n_workers, exception_handler_type handler_):
+        thread_pool_v6(n_workers, 1024, std::move(handler_))
+    {}
+    thread_pool_v6(std::size_t n_workers, std::size_t n_tasks, exception_handler_type handler_ = exception_handler_type{}):
+        detached_exception_handler{std::move(handler_)},
+        workers(n_workers),
+        tasks(n_tasks)
+    {
+        init();
+    }
+
+    //return task_future<R> object, where R is return type of F called with args, future will sync when destroyed
+    //std::reference_wrapper should be used to pass args by ref
+    //Promise may be light_promise to have task_future without std::promise shared state
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push(F&& f, Args&&...args){return push_<true, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
+    //returned future will not sync when destroyed
+    template<template<typename> typename Promise = std::promise, typename F, typename...Args>
+    auto push_async(F&& f, Args&&...args){return push_<false, Promise>(std::forward<F>(f), std::forward<Args>(args)...);}
+    //bind task to group
+    template<typename F, typename...Args>
+    void push_group(task_group& group, F&& f, Args&&...args){
+        task_type task{};
+        task.set_group_task(group, std::forward<F>(f), std::forward<Args>(args)...);
+        group.inc();
+        push_task(task);
+    }
+    //task has no future, exception thrown by task is passed to exception handler
+    template<typename F, typename...Args>
+    void push_detached(F&& f, Args&&...args){
+        task_type task{};
+        task.set_detached_task(exception_handler(), std::forward<F>(f), std::forward<Args>(args)...);
+        push_task(task);
+    }
+    //like above but not blocking, returns false if task queue is full
+    template<typename F, typename...Args>
+    bool try_push_detached(F&& f, Args&&...args){
+        task_type task{};
+        task.set_detached_task(exception_handler(), std::forward<F>(f), std::forward<Args>(args)...);
+        if (tasks.try_push(std::move(task))){
+            has_task.notify_one();
+            return true;
+        }
+        return false;
+    }
+
+private:
+
+    template<bool Sync, template<typename> typename Promise, typename F, typename...Args>
+    auto push_(F&& f, Args&&...args){
+        task_type task{};
+        auto future = task.template set_task<Promise>(Sync, std::forward<F>(f), std::forward<Args>(args)...);
+        push_task(task);
+        return future;
+    }
+
+    //task is moved to queue only if push succeeds
+    void push_task(task_type& task){
+        while(!tasks.try_push(std::move(task))){
+            auto key = has_slot.prepare_wait();
+            if (tasks.try_push(std::move(task))){
+                has_slot.cancel_wait();
+                break;
+            }
+            has_slot.wait(key);
+        }
+        has_task.notify_one();
+    }
+
+    void init(){
+        std::for_each(workers.begin(),workers.end(),[this](auto& worker){worker=std::thread{&thread_pool_v6::worker_loop, this};});
+    }
+
+    void stop(){
+        finish_workers.store(true);
+        has_task.notify_all();
+        std::for_each(workers.begin(),workers.end(),[](auto& worker){worker.join();});
+    }
+
+    //waiting pusher is notified when queue is at most half full, so it is not woken for every free slot
+    auto try_pop(){
+        auto t = tasks.try_pop();
+        if (t && tasks.size() <= tasks.capacity()/2){
+            has_slot.notify_all();
+        }
+        return t;
+    }
+
+    void worker_loop(){
+        while(!finish_workers.load()){  //worker loop
+            if (auto t = try_pop()){
+                t.get().call();
+                continue;
+            }
+            auto key = has_task.prepare_wait();
+            if (finish_workers.load()){
+                has_task.cancel_wait();
+                break;
+            }
+            if (auto t = try_pop()){
+                has_task.cancel_wait();
+                t.get().call();
+                continue;
+            }
+            has_task.wait(key);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    queue_type tasks;
+    std::atomic<bool> finish_workers{false};
+    event_count_type has_task;
+    event_count_type has_slot;
 };
 
 }   //end of namespace thread_pool
@@ -0,0 +1,223 @@
+#include <thread>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <numeric>
+#include "catch.hpp"
+#include "async_queue.hpp"
+#include "thread_pool.hpp"
+
+namespace test_async_queue{
+
+//coroutine that starts immediately and is destroyed when completes
+struct detached_task{
+    struct promise_type{
+        detached_task get_return_object(){return {};}
+        std::suspend_never initial_suspend()noexcept{return {};}
+        std::suspend_never final_suspend()noexcept{return {};}
+        void return_void(){}
+        void unhandled_exception(){std::terminate();}
+    };
+};
+
+template<typename Queue>
+detached_task consumer(Queue& queue, std::size_t n, std::atomic<std::size_t>& sum, std::atomic<std::size_t>& completed){
+    for (std::size_t i{0}; i!=n; ++i){
+        sum.fetch_add(co_await queue.pop_async());
+    }
+    completed.fetch_add(1);
+}
+
+template<typename Queue>
+detached_task producer(Queue& queue, std::size_t first, std::size_t last, std::atomic<std::size_t>& completed){
+    for (; first!=last; ++first){
+        co_await queue.push_async(first);
+    }
+    completed.fetch_add(1);
+}
+
+//pops one element and records thread it is resumed on
+template<typename Queue>
+detached_task resumed_on(Queue& queue, std::atomic<std::thread::id>& id, std::atomic<std::size_t>& completed){
+    co_await queue.pop_async();
+    id.store(std::this_thread::get_id());
+    completed.fetch_add(1);
+}
+
+inline void wait_for(const std::atomic<std::size_t>& counter, std::size_t expected){
+    while(counter.load() != expected){
+        std::this_thread::yield();
+    }
+}
+
+}   //end of namespace test_async_queue
+
+TEST_CASE("test_mpmc_bounded_async_queue","[test_mpmc_bounded_async_queue]")
+{
+    using value_type = std::size_t;
+    using executor_type = thread_pool::thread_pool_v3;
+    using queue_type = queue::mpmc_bounded_async_queue<value_type, executor_type>;
+    using test_async_queue::consumer;
+    using test_async_queue::producer;
+    using test_async_queue::wait_for;
+    static constexpr std::size_t capacity = 4;
+
+    executor_type executor{2, 64};
+    queue_type queue{capacity, executor};
+    REQUIRE(queue.capacity() == capacity);
+    REQUIRE(queue.size() == 0);
+    value_type v{};
+    REQUIRE(!queue.try_pop(v));
+
+    SECTION("not_blocking"){
+        for (std::size_t i{0}; i!=capacity; ++i){
+            REQUIRE(queue.try_push(i));
+        }
+        REQUIRE(!queue.try_push(value_type{0}));
+        REQUIRE(queue.size() == capacity);
+        for (std::size_t i{0}; i!=capacity; ++i){
+            REQUIRE(queue.try_pop(v));
+            REQUIRE(v == i);
+        }
+        REQUIRE(!queue.try_pop(v));
+    }
+    SECTION("suspended_consumers"){
+        static constexpr std::size_t n_consumers = 16;
+        std::atomic<std::size_t> sum{0};
+        std::atomic<std::size_t> completed{0};
+        for (std::size_t i{0}; i!=n_consumers; ++i){
+            consumer(queue, 1, sum, completed);
+        }
+        REQUIRE(completed.load() == 0);
+        for (std::size_t i{0}; i!=n_consumers; ++i){
+            while(!queue.try_push(i)){
+                std::this_thread::yield();
+            }
+        }
+        wait_for(completed, n_consumers);
+        REQUIRE(sum.load() == n_consumers*(n_consumers-1)/2);
+        REQUIRE(queue.size() == 0);
+    }
+    SECTION("suspended_producers"){
+        static constexpr std::size_t n_elements = 16;
+        std::atomic<std::size_t> completed{0};
+        producer(queue, 0, n_elements, completed);
+        REQUIRE(completed.load() == 0);
+        REQUIRE(queue.size() == capacity);
+        std::vector<value_type> result{};
+        while(result.size() != n_elements){
+            if (queue.try_pop(v)){
+                result.push_back(v);
+            }else{
+                std::this_thread::yield();
+            }
+        }
+        wait_for(completed, 1);
+        std::vector<value_type> expected(n_elements);
+        std::iota(expected.begin(),expected.end(),value_type{0});
+        REQUIRE(result == expected);
+    }
+}
+
+TEST_CASE("test_mpmc_bounded_async_queue_multithread","[test_mpmc_bounded_async_queue]")
+{
+    using value_type = std::size_t;
+    using executor_type = thread_pool::thread_pool_v3;
+    using queue_type = queue::mpmc_bounded_async_queue<value_type, executor_type>;
+    using test_async_queue::consumer;
+    using test_async_queue::producer;
+    using test_async_queue::wait_for;
+    static constexpr std::size_t capacity = 16;
+    static constexpr std::size_t n_consumers = 1000;
+    static constexpr std::size_t n_producers = 100;
+    static constexpr std::size_t n_elements = 100*1000;
+    static constexpr std::size_t n_workers = 4;
+
+    executor_type executor{n_workers, n_consumers+n_producers};
+    queue_type queue{capacity, executor};
+    std::atomic<std::size_t> sum{0};
+    std::atomic<std::size_t> completed_consumers{0};
+    std::atomic<std::size_t> completed_producers{0};
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumer(queue, n_elements/n_consumers, sum, completed_consumers);
+    }
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producer(queue, i*n_elements/n_producers, (i+1)*n_elements/n_producers, completed_producers);
+    }
+    wait_for(completed_producers, n_producers);
+    wait_for(completed_consumers, n_consumers);
+    REQUIRE(sum.load() == n_elements*(n_elements-1)/2);
+    REQUIRE(queue.size() == 0);
+}
+
+//more waiters than executor task queue can hold, coroutines are resumed in place when executor queue is full
+TEMPLATE_TEST_CASE("test_mpmc_bounded_async_queue_small_executor","[test_mpmc_bounded_async_queue]",
+    thread_pool::thread_pool_v3,
+    thread_pool::thread_pool_v4,
+    thread_pool::thread_pool_v6
+)
+{
+    using value_type = std::size_t;
+    using executor_type = TestType;
+    using queue_type = queue::mpmc_bounded_async_queue<value_type, executor_type>;
+    using test_async_queue::consumer;
+    using test_async_queue::producer;
+    using test_async_queue::wait_for;
+    static constexpr std::size_t capacity = 2;
+    static constexpr std::size_t n_consumers = 64;
+    static constexpr std::size_t n_producers = 64;
+    static constexpr std::size_t n_elements = 10;
+
+    executor_type executor{2};
+    queue_type queue{capacity, executor};
+    std::atomic<std::size_t> sum{0};
+    std::atomic<std::size_t> completed_consumers{0};
+    std::atomic<std::size_t> completed_producers{0};
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumer(queue, n_elements, sum, completed_consumers);
+    }
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producer(queue, i*n_elements, (i+1)*n_elements, completed_producers);
+    }
+    wait_for(completed_producers, n_producers);
+    wait_for(completed_consumers, n_consumers);
+    const auto n = n_producers*n_elements;
+    REQUIRE(sum.load() == n*(n-1)/2);
+    REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE("test_mpmc_bounded_async_queue_overflow","[test_mpmc_bounded_async_queue]")
+{
+    using value_type = std::size_t;
+    using executor_type = thread_pool::thread_pool_v3;
+    using queue_type = queue::mpmc_bounded_async_queue<value_type, executor_type>;
+    using test_async_queue::resumed_on;
+    using test_async_queue::wait_for;
+
+    executor_type executor{1, 1};
+    queue_type queue{4, executor};
+    //worker is busy and executor queue is full
+    std::atomic<bool> gate{false};
+    std::atomic<std::size_t> started{0};
+    auto blocker = [&gate, &started](){
+        started.fetch_add(1);
+        while(!gate.load()){
+            std::this_thread::yield();
+        }
+    };
+    executor.push_detached(blocker);
+    wait_for(started, 1);
+    executor.push_detached(blocker);
+    std::atomic<std::thread::id> id{};
+    std::atomic<std::size_t> completed{0};
+    resumed_on(queue, id, completed);
+    std::thread opener{[&gate](){
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        gate.store(true);
+    }};
+    //coroutine is not resumed on releasing thread
+    REQUIRE(queue.try_push(value_type{1}));
+    wait_for(completed, 1);
+    REQUIRE(id.load() != std::this_thread::get_id());
+    opener.join();
+}
@@ -84,13 +84,15 @@ TEST_CASE("test_range_constructor","[test_bounded_pool]")
     REQUIRE(result == expected);
 }
 
-TEST_CASE("test_pop","[test_bounded_pool]")
+TEMPLATE_TEST_CASE("test_pop","[test_bounded_pool]",
+    (bounded_pool::mc_bounded_pool<float>),
+    (bounded_pool::mc_bounded_lifo_pool<float>)
+)
 {
-    using value_type = float;
-    using bounded_pool::mc_bounded_pool;
+    using pool_type = TestType;
     static constexpr std::size_t pool_size = 10;
 
-    mc_bounded_pool<value_type> pool{pool_size};
+    pool_type pool{pool_size};
     {
         auto e = pool.try_pop();
         REQUIRE(e);
@@ -125,6 +127,36 @@ TEST_CASE("test_pop","[test_bounded_pool]")
     REQUIRE(pool.size() == pool_size);
 }
 
+TEST_CASE("test_lifo_reuse","[test_bounded_pool]")
+{
+    using value_type = float;
+    using bounded_pool::mc_bounded_lifo_pool;
+    static constexpr std::size_t pool_size = 10;
+    std::vector<value_type> values(pool_size);
+    std::iota(values.begin(),values.end(), 0.0f);
+    mc_bounded_lifo_pool<value_type> pool{values.begin(), values.end()};
+    REQUIRE(pool.size() == pool_size);
+    std::vector<value_type> result{};
+    {
+        std::vector<decltype(pool.try_pop())> result_elements{};
+        while(auto e = pool.try_pop()){
+            result_elements.push_back(e);
+        }
+        REQUIRE(pool.size() == 0);
+        std::for_each(result_elements.begin(), result_elements.end(), [&result](const auto& e){result.push_back(e.get());});
+    }
+    REQUIRE(pool.size() == pool_size);
+    REQUIRE(std::equal(result.begin(), result.end(), values.rbegin()));
+    //most recently released object is reused first
+    const value_type* released{nullptr};
+    {
+        auto e = pool.pop();
+        auto e1 = pool.pop();
+        released = &e.get();
+    }
+    REQUIRE(&pool.pop().get() == released);
+}
+
 TEST_CASE("test_copy_constructor","[test_bounded_pool]")
 {
     using value_type = float;
@@ -156,6 +188,140 @@ TEST_CASE("test_reset","[test_bounded_pool]")
     REQUIRE(pool.size() == pool_size);
 }
 
+TEMPLATE_TEST_CASE("test_pop_unique","[test_bounded_pool]",
+    (bounded_pool::mc_bounded_pool<float>),
+    (bounded_pool::mc_bounded_lifo_pool<float>)
+)
+{
+    using pool_type = TestType;
+    static constexpr std::size_t size = 64;
+
+    pool_type pool{size, 1.0f};
+    {
+        auto e = pool.pop_unique();
+        REQUIRE(e);
+        REQUIRE(e.get() == 1.0f);
+        REQUIRE(pool.size() == size-1);
+        auto e1{std::move(e)};
+        REQUIRE(!e);
+        REQUIRE(e1);
+        e1.get() = 2.0f;
+        e1.reset();
+        REQUIRE(!e1);
+        REQUIRE(pool.size() == size);
+    }
+    {
+        auto e = pool.try_pop_unique();
+        REQUIRE(e);
+        REQUIRE(pool.size() == size-1);
+        e = pool.pop_unique();
+        REQUIRE(pool.size() == size-1);
+    }
+    REQUIRE(pool.size() == size);
+    //unique_element rvalue converts to shared_element
+    {
+        decltype(pool.pop()) shared = pool.pop_unique();
+        REQUIRE(shared.use_count() == 1);
+        REQUIRE(pool.size() == size-1);
+        auto shared_copy{shared};
+        REQUIRE(shared.use_count() == 2);
+        shared.reset();
+        REQUIRE(pool.size() == size-1);
+    }
+    REQUIRE(pool.size() == size);
+    {
+        std::vector<decltype(pool.pop_unique())> v{};
+        while(auto e = pool.try_pop_unique()){
+            v.push_back(std::move(e));
+        }
+        REQUIRE(pool.size() == 0);
+        REQUIRE(!pool.try_pop_unique());
+        decltype(pool.pop()) empty_shared = pool.try_pop_unique();
+        REQUIRE(!empty_shared);
+    }
+    REQUIRE(pool.size() == size);
+    //default constructed elements are empty and may be destroyed or assigned
+    {
+        decltype(pool.pop_unique()) e{};
+        REQUIRE(!e);
+        decltype(pool.pop()) shared{};
+        REQUIRE(!shared);
+        e = pool.pop_unique();
+        REQUIRE(pool.size() == size-1);
+    }
+    REQUIRE(pool.size() == size);
+}
+
+TEMPLATE_TEST_CASE("test_pop_n","[test_bounded_pool]",
+    (bounded_pool::mc_bounded_pool<float>),
+    (bounded_pool::mc_bounded_lifo_pool<float>)
+)
+{
+    using pool_type = TestType;
+    static constexpr std::size_t pool_size = 10;
+
+    pool_type pool{pool_size};
+    std::vector<decltype(pool.pop())> v{};
+    REQUIRE_THROWS_AS(pool.try_pop_n(std::back_inserter(v), pool_size+1), std::invalid_argument);
+    REQUIRE(pool.try_pop_n(std::back_inserter(v), 4));
+    REQUIRE(v.size() == 4);
+    REQUIRE(pool.size() == pool_size-4);
+    REQUIRE(std::all_of(v.begin(),v.end(),[](const auto& e){return e.use_count() == 1;}));
+    //all or nothing
+    REQUIRE(!pool.try_pop_n(std::back_inserter(v), pool_size-3));
+    REQUIRE(v.size() == 4);
+    REQUIRE(pool.size() == pool_size-4);
+    pool.pop_n(std::back_inserter(v), pool_size-4);
+    REQUIRE(v.size() == pool_size);
+    REQUIRE(pool.size() == 0);
+    std::set<const float*> objects{};
+    std::for_each(v.begin(),v.end(),[&objects](const auto& e){objects.insert(&e.get());});
+    REQUIRE(objects.size() == pool_size);
+    REQUIRE(pool.try_pop_n(std::back_inserter(v), 0));
+    v.clear();
+    REQUIRE(pool.size() == pool_size);
+}
+
+TEMPLATE_TEST_CASE("test_pop_n_multithread","[test_bounded_pool]",
+    (bounded_pool::mc_bounded_pool<std::size_t>),
+    (bounded_pool::mc_bounded_lifo_pool<std::size_t>)
+)
+{
+    using pool_type = TestType;
+    static constexpr std::size_t pool_size = 5;
+    static constexpr std::size_t set_size = 3;
+    static constexpr std::size_t n_threads = 4;
+    static constexpr std::size_t n_iterations = 10000;
+
+    pool_type pool{pool_size};
+    std::array<std::thread, n_threads> threads{};
+    for (auto& t : threads){
+        t = std::thread{[&pool](){
+            std::array<decltype(pool.pop()), set_size> set{};
+            for (std::size_t i{0}; i!=n_iterations; ++i){
+                if (i%2){
+                    pool.pop_n(set.begin(), set_size);
+                }else{
+                    while(!pool.try_pop_n(set.begin(), set_size)){
+                        std::this_thread::yield();
+                    }
+                }
+                std::for_each(set.begin(),set.end(),[](auto& e){++e.get();});
+                std::for_each(set.begin(),set.end(),[](auto& e){e.reset();});
+            }
+        }};
+    }
+    std::for_each(threads.begin(),threads.end(),[](auto& t){t.join();});
+    REQUIRE(pool.size() == pool_size);
+    std::size_t sum{0};
+    {
+        std::vector<decltype(pool.pop())> v{};
+        pool.pop_n(std::back_inserter(v), pool_size);
+        std::for_each(v.begin(),v.end(),[&sum](const auto& e){sum += e.get();});
+    }
+    REQUIRE(sum == n_threads*n_iterations*set_size);
+}
+
 namespace test_mc_bounded_pool_multithread{
 
 struct consumer{
@@ -183,13 +349,15 @@ struct consumer{
 
 }   //end of namespace test_mc_bounded_pool_multithread
 
-TEST_CASE("test_multithread","[test_bounded_pool]")
+TEMPLATE_TEST_CASE("test_multithread","[test_bounded_pool]",
+    (bounded_pool::mc_bounded_pool<float>),
+    (bounded_pool::mc_bounded_lifo_pool<float>)
+)
 {
     using value_type = float;
-    using bounded_pool::mc_bounded_pool;
     using benchmark_helpers::make_ranges;
     using consumer_type = test_mc_bounded_pool_multithread::consumer;
-    using pool_type = mc_bounded_pool<value_type>;
+    using pool_type = TestType;
     static constexpr std::size_t n_consumers = 10;
     static constexpr std::size_t pool_size = 1*1000*1000;
 
@@ -214,3 +382,417 @@ TEST_CASE("test_multithread","[test_bounded_pool]")
     std::sort(result.begin(),result.end());
     REQUIRE(result == expected);
 }
+
+TEST_CASE("test_cached_pool","[test_bounded_pool]")
+{
+    using value_type = float;
+    static constexpr std::size_t pool_size = 64;
+    static constexpr std::size_t magazine_size = 8;
+    using pool_type = bounded_pool::mc_bounded_cached_pool<value_type, magazine_size>;
+
+    pool_type pool{pool_size};
+    REQUIRE(pool.size() == pool_size);
+    //first pop refills magazine with half of magazine_size objects, size counts magazine
+    const value_type* released{nullptr};
+    {
+        auto e = pool.pop();
+        REQUIRE(e.use_count() == 1);
+        released = &e.get();
+        REQUIRE(pool.size() == pool_size-1);
+    }
+    //released object is cached in magazine and reused first
+    REQUIRE(pool.size() == pool_size);
+    for (std::size_t i{0}; i!=100; ++i){
+        auto e = pool.try_pop();
+        REQUIRE(e);
+        REQUIRE(&e.get() == released);
+    }
+    REQUIRE(pool.size() == pool_size);
+    //full magazine is flushed to shared pool
+    {
+        std::vector<decltype(pool.pop())> v{};
+        for (std::size_t i{0}; i!=pool_size; ++i){
+            v.push_back(pool.pop());
+        }
+        REQUIRE(pool.size() == 0);
+        REQUIRE(!pool.try_pop());
+    }
+    REQUIRE(pool.size() == pool_size);
+    //release of thread that never popped goes to shared pool
+    {
+        auto e = pool.pop();
+        auto size = pool.size();
+        std::thread t{[e_ = std::move(e)]()mutable{e_.reset();}};
+        t.join();
+        REQUIRE(pool.size() == size+1);
+    }
+    //magazine is flushed when thread exits
+    {
+        auto size = pool.size();
+        std::thread t{[&pool](){
+            for (std::size_t i{0}; i!=100; ++i){
+                auto e = pool.pop();
+            }
+        }};
+        t.join();
+        REQUIRE(pool.size() == size);
+    }
+}
+
+TEST_CASE("test_cached_pool_drain","[test_bounded_pool]")
+{
+    using value_type = float;
+    static constexpr std::size_t pool_size = 8;
+    static constexpr std::size_t magazine_size = 8;
+    using pool_type = bounded_pool::mc_bounded_cached_pool<value_type, magazine_size>;
+
+    pool_type pool{pool_size};
+    //other thread caches free objects in its magazine and stays alive
+    std::atomic<bool> cached{false};
+    std::atomic<bool> done{false};
+    std::thread t{[&](){
+        pool.pop();
+        cached.store(true);
+        while(!done.load()){
+            std::this_thread::yield();
+        }
+    }};
+    while(!cached.load()){
+        std::this_thread::yield();
+    }
+    REQUIRE(pool.size() == pool_size);
+    SECTION("pop"){
+        std::vector<decltype(pool.pop())> v{};
+        for (std::size_t i{0}; i!=pool_size; ++i){
+            v.push_back(pool.pop());
+        }
+        REQUIRE(pool.size() == 0);
+    }
+    SECTION("pop_n"){
+        std::vector<decltype(pool.pop())> v{};
+        pool.pop_n(std::back_inserter(v), pool_size);
+        REQUIRE(v.size() == pool_size);
+        REQUIRE(pool.size() == 0);
+    }
+    REQUIRE(pool.size() == pool_size);
+    done.store(true);
+    t.join();
+    REQUIRE(pool.size() == pool_size);
+}
+
+TEST_CASE("test_cached_pool_multithread","[test_bounded_pool]")
+{
+    using value_type = std::size_t;
+    static constexpr std::size_t pool_size = 64;
+    static constexpr std::size_t magazine_size = 8;
+    static constexpr std::size_t n_threads = 4;
+    static constexpr std::size_t n_iterations = 10000;
+    using pool_type = bounded_pool::mc_bounded_cached_pool<value_type, magazine_size>;
+
+    pool_type pool{pool_size};
+    std::array<std::thread, n_threads> threads{};
+    for (auto& t : threads){
+        t = std::thread{[&pool](){
+            for (std::size_t i{0}; i!=n_iterations; ++i){
+                if (i%2){
+                    ++pool.pop().get();
+                }else{
+                    while(true){
+                        if (auto e = pool.try_pop()){
+                            ++e.get();
+                            break;
+                        }
+                    }
+                }
+            }
+        }};
+    }
+    std::for_each(threads.begin(),threads.end(),[](auto& t){t.join();});
+    REQUIRE(pool.size() == pool_size);
+    std::size_t sum{0};
+    {
+        std::vector<decltype(pool.pop())> v{};
+        while(auto e = pool.try_pop()){
+            sum += e.get();
+            v.push_back(e);
+        }
+        REQUIRE(v.size() == pool_size);
+    }
+    REQUIRE(sum == n_threads*n_iterations);
+}
+
+TEST_CASE("test_elastic_pool","[test_bounded_pool]")
+{
+    using value_type = std::vector<float>;
+    using pool_type = bounded_pool::mc_elastic_pool<value_type>;
+    using namespace std::chrono_literals;
+    static constexpr std::size_t low_watermark = 2;
+    static constexpr std::size_t high_watermark = 4;
+    static constexpr std::size_t hard_limit = 8;
+    static constexpr auto decay = 50ms;
+    const value_type v(10, 1.0f);
+
+    REQUIRE_THROWS_AS(pool_type(low_watermark, high_watermark, 0, decay, v), std::invalid_argument);
+    REQUIRE_THROWS_AS(pool_type(high_watermark, low_watermark, hard_limit, decay, v), std::invalid_argument);
+    REQUIRE_THROWS_AS(pool_type(low_watermark, hard_limit+1, hard_limit, decay, v), std::invalid_argument);
+
+    pool_type pool{low_watermark, high_watermark, hard_limit, decay, v};
+    REQUIRE(pool.size() == low_watermark);
+    REQUIRE(pool.capacity() == low_watermark);
+    REQUIRE(pool.hard_limit() == hard_limit);
+    //grow up to hard limit, new objects are constructed from copies of args
+    {
+        std::vector<decltype(pool.pop())> objects{};
+        for (std::size_t i{0}; i!=hard_limit; ++i){
+            auto e = i%2 ? pool.pop() : pool.try_pop();
+            REQUIRE(e);
+            REQUIRE(e.get() == v);
+            objects.push_back(e);
+        }
+        REQUIRE(pool.size() == 0);
+        REQUIRE(pool.capacity() == hard_limit);
+        REQUIRE(!pool.try_pop());
+    }
+    REQUIRE(pool.size() == hard_limit);
+    //surplus is not destroyed until decay period elapsed
+    pool.pop();
+    pool.shrink();
+    REQUIRE(pool.capacity() == hard_limit);
+    //surplus is destroyed on pop after decay period
+    std::this_thread::sleep_for(2*decay);
+    {
+        auto e = pool.pop();
+        REQUIRE(pool.size() == high_watermark);
+        REQUIRE(pool.capacity() == high_watermark+1);
+    }
+    REQUIRE(pool.size() == high_watermark+1);
+    std::this_thread::sleep_for(2*decay);
+    pool.shrink();
+    REQUIRE(pool.size() == high_watermark);
+    REQUIRE(pool.capacity() == high_watermark);
+    {
+        auto e = pool.pop_unique();
+        REQUIRE(e.get() == v);
+        REQUIRE(pool.size() == high_watermark-1);
+    }
+    REQUIRE(pool.size() == high_watermark);
+    //idle objects not above high watermark are kept
+    std::this_thread::sleep_for(2*decay);
+    pool.shrink();
+    REQUIRE(pool.capacity() == high_watermark);
+    //surplus is destroyed on release after decay period
+    {
+        std::vector<decltype(pool.pop())> objects{};
+        for (std::size_t i{0}; i!=hard_limit; ++i){
+            objects.push_back(pool.pop());
+        }
+        REQUIRE(pool.capacity() == hard_limit);
+        for (std::size_t i{0}; i!=high_watermark+1; ++i){
+            objects.pop_back();
+        }
+        REQUIRE(pool.size() == high_watermark+1);
+        std::this_thread::sleep_for(2*decay);
+        objects.pop_back();
+        REQUIRE(pool.size() == high_watermark);
+        REQUIRE(pool.capacity() == hard_limit-2);
+    }
+}
+
+namespace test_elastic_pool_multithread{
+
+//adds its count to total when destroyed
+struct counted{
+    std::atomic<std::size_t>* total;
+    std::size_t count{0};
+    explicit counted(std::atomic<std::size_t>* total_):
+        total{total_}
+    {}
+    ~counted(){total->fetch_add(count);}
+};
+
+}   //end of namespace test_elastic_pool_multithread
+
+TEST_CASE("test_elastic_pool_multithread","[test_bounded_pool]")
+{
+    using value_type = test_elastic_pool_multithread::counted;
+    using pool_type = bounded_pool::mc_elastic_pool<value_type>;
+    using namespace std::chrono_literals;
+    static constexpr std::size_t n_threads = 4;
+    static constexpr std::size_t n_iterations = 10000;
+    static constexpr std::size_t hard_limit = 8;
+
+    std::atomic<std::size_t> total{0};
+    {
+        pool_type pool{1, 2, hard_limit, 1ms, &total};
+        std::array<std::thread, n_threads> threads{};
+        for (auto& t : threads){
+            t = std::thread{[&pool](){
+                for (std::size_t i{0}; i!=n_iterations; ++i){
+                    if (i%2){
+                        auto e = pool.pop();
+                        auto e1 = pool.pop();
+                        ++e.get().count;
+                        ++e1.get().count;
+                    }else{
+                        while(true){
+                            if (auto e = pool.try_pop()){
+                                e.get().count += 2;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }};
+        }
+        std::for_each(threads.begin(),threads.end(),[](auto& t){t.join();});
+        REQUIRE(pool.capacity() <= hard_limit);
+        REQUIRE(pool.size() == pool.capacity());
+    }
+    //destroyed objects, surplus and remaining ones, add their counts to total
+    REQUIRE(total.load() == 2*n_threads*n_iterations);
+}
+
+namespace test_lazy_pool{
+
+//counts constructed and destroyed objects
+struct counted{
+    std::atomic<std::size_t>* constructed;
+    std::atomic<std::size_t>* destroyed;
+    std::vector<int> data{};
+    counted(std::atomic<std::size_t>* constructed_, std::atomic<std::size_t>* destroyed_):
+        constructed{constructed_},
+        destroyed{destroyed_}
+    {
+        constructed->fetch_add(1);
+    }
+    ~counted(){destroyed->fetch_add(1);}
+};
+
+}   //end of namespace test_lazy_pool
+
+TEST_CASE("test_lazy_pool","[test_bounded_pool]")
+{
+    using value_type = test_lazy_pool::counted;
+    using pool_type = bounded_pool::mc_lazy_pool<value_type>;
+    static constexpr std::size_t capacity = 4;
+
+    std::atomic<std::size_t> constructed{0};
+    std::atomic<std::size_t> destroyed{0};
+    {
+        pool_type pool{capacity, nullptr, false, &constructed, &destroyed};
+        REQUIRE(pool.capacity() == capacity);
+        REQUIRE(pool.size() == 0);
+        REQUIRE(pool.constructed() == 0);
+        REQUIRE(constructed == 0);
+        //object is constructed on first acquisition and then reused
+        {
+            auto e = pool.pop();
+            e.get().data.push_back(1);
+            REQUIRE(constructed == 1);
+        }
+        REQUIRE(pool.size() == 1);
+        {
+            auto e = pool.pop_unique();
+            REQUIRE(e.get().data.size() == 1);  //no reset hook
+            REQUIRE(constructed == 1);
+        }
+        {
+            std::vector<decltype(pool.pop())> objects{};
+            while(auto e = pool.try_pop()){
+                objects.push_back(e);
+            }
+            REQUIRE(objects.size() == capacity);
+            REQUIRE(pool.constructed() == capacity);
+            REQUIRE(pool.size() == 0);
+        }
+        REQUIRE(pool.size() == capacity);
+        REQUIRE(constructed == capacity);
+    }
+    REQUIRE(destroyed == capacity);
+}
+
+TEST_CASE("test_lazy_pool_reset","[test_bounded_pool]")
+{
+    using value_type = test_lazy_pool::counted;
+    using pool_type = bounded_pool::mc_lazy_pool<value_type>;
+    static constexpr std::size_t capacity = 4;
+
+    std::atomic<std::size_t> constructed{0};
+    std::atomic<std::size_t> destroyed{0};
+    std::atomic<std::size_t> reset_count{0};
+    const auto reset = [&reset_count](value_type& v){v.data.clear(); ++reset_count;};
+    SECTION("on_release"){
+        {
+            pool_type pool{capacity, reset, false, &constructed, &destroyed};
+            {
+                auto e = pool.pop();
+                e.get().data.push_back(1);
+            }
+            REQUIRE(reset_count == 1);
+            REQUIRE(pool.size() == 1);
+            REQUIRE(pool.pop().get().data.empty());
+            REQUIRE(reset_count == 2);
+        }
+        REQUIRE(destroyed == constructed);
+    }
+    SECTION("async"){
+        {
+            pool_type pool{capacity, reset, true, &constructed, &destroyed};
+            {
+                auto e = pool.pop_unique();
+                e.get().data.push_back(1);
+            }
+            //object is idle after background thread resets it
+            while(pool.empty()){
+                std::this_thread::yield();
+            }
+            REQUIRE(reset_count == 1);
+            {
+                auto e = pool.pop();
+                REQUIRE(e.get().data.empty());
+                REQUIRE(pool.constructed() == 1);
+                e.get().data.push_back(1);
+                auto e1 = pool.pop();
+                e1.get().data.push_back(1);
+            }
+            //released objects are reset before pool is destroyed
+        }
+        REQUIRE(reset_count == 3);
+        REQUIRE(destroyed == constructed);
+        REQUIRE(destroyed == 2);
+    }
+}
+
+TEST_CASE("test_lazy_pool_multithread","[test_bounded_pool]")
+{
+    using value_type = std::vector<int>;
+    using pool_type = bounded_pool::mc_lazy_pool<value_type>;
+    static constexpr std::size_t capacity = 4;
+    static constexpr std::size_t n_threads = 4;
+    static constexpr std::size_t n_iterations = 10000;
+
+    const auto async_reset = GENERATE(false, true);
+    std::atomic<bool> clean{true};
+    pool_type pool{capacity, [](value_type& v){v.clear();}, async_reset};
+    std::array<std::thread, n_threads> threads{};
+    for (auto& t : threads){
+        t = std::thread{[&pool,&clean](){
+            auto use = [&clean](auto e){
+                if (!e.get().empty()){
+                    clean.store(false);
+                }
+                e.get().push_back(1);
+            };
+            for (std::size_t i{0}; i!=n_iterations; ++i){
+                if (i%2){
+                    use(pool.pop());
+                }else{
+                    use(pool.pop_unique());
+                }
+            }
+        }};
+    }
+    std::for_each(threads.begin(),threads.end(),[](auto& t){t.join();});
+    REQUIRE(clean.load());
+    REQUIRE(pool.constructed() <= capacity);
+}
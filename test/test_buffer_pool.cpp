@@ -0,0 +1,274 @@
+#include <thread>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <memory_resource>
+#include "catch.hpp"
+#include "buffer_pool.hpp"
+
+namespace test_buffer_pool{
+
+inline auto is_aligned(const void* p, std::size_t alignment){
+    return reinterpret_cast<std::uintptr_t>(p)%alignment == 0;
+}
+
+//upstream resource that counts allocations
+class counting_resource : public std::pmr::memory_resource
+{
+    void* do_allocate(std::size_t bytes, std::size_t alignment)override{
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment)override{
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other)const noexcept override{
+        return this == &other;
+    }
+public:
+    std::size_t allocations{0};
+    std::size_t deallocations{0};
+};
+
+}   //end of namespace test_buffer_pool
+
+TEST_CASE("test_buffer_pool","[test_buffer_pool]")
+{
+    using bounded_pool::buffer_pool;
+    using test_buffer_pool::is_aligned;
+    static constexpr std::size_t buffers_number = 8;
+    static constexpr std::size_t buffer_size = 1000;
+
+    REQUIRE_THROWS_AS(buffer_pool(buffers_number, buffer_size, 48), std::invalid_argument);
+    REQUIRE_THROWS_AS(buffer_pool(0, buffer_size), std::invalid_argument);
+    REQUIRE_THROWS_AS(buffer_pool(buffers_number, 0), std::invalid_argument);
+
+    const auto alignment = GENERATE(std::size_t{64}, buffer_pool::page_size(), 4*buffer_pool::page_size());
+    const auto populate = GENERATE(false, true);
+    buffer_pool pool{buffers_number, buffer_size, alignment, populate};
+    REQUIRE(pool.size() == buffers_number);
+    REQUIRE(pool.capacity() == buffers_number);
+    REQUIRE(pool.buffer_size() == buffer_size);
+    REQUIRE(pool.alignment() == alignment);
+    {
+        std::vector<decltype(pool.pop())> buffers{};
+        while(auto b = pool.try_pop()){
+            REQUIRE(b.get().size() == buffer_size);
+            REQUIRE(is_aligned(b.get().data(), alignment));
+            std::fill(b.get().begin(), b.get().end(), static_cast<std::byte>(buffers.size()));
+            buffers.push_back(b);
+        }
+        REQUIRE(buffers.size() == buffers_number);
+        REQUIRE(pool.size() == 0);
+        //buffers do not overlap
+        for (std::size_t i{0}; i!=buffers.size(); ++i){
+            const auto& b = buffers[i].get();
+            REQUIRE(std::all_of(b.begin(), b.end(), [i](auto v){return v == static_cast<std::byte>(i);}));
+        }
+    }
+    REQUIRE(pool.size() == buffers_number);
+    {
+        auto b = pool.pop_unique();
+        REQUIRE(b.get().size() == buffer_size);
+        REQUIRE(pool.size() == buffers_number-1);
+    }
+    REQUIRE(pool.size() == buffers_number);
+#ifdef __cpp_lib_span
+    {
+        auto b = pool.pop();
+        std::span<std::byte> s = b.get().span();
+        REQUIRE(s.data() == b.get().data());
+        REQUIRE(s.size() == buffer_size);
+    }
+#endif
+}
+
+TEST_CASE("test_buffer_pool_lock","[test_buffer_pool]")
+{
+    using bounded_pool::buffer_pool;
+    static constexpr std::size_t buffers_number = 4;
+    static constexpr std::size_t buffer_size = 4096;
+    //mlock may be not permitted by RLIMIT_MEMLOCK, in this case pool construction throws system_error
+    try{
+        buffer_pool pool{buffers_number, buffer_size, buffer_pool::page_size(), true, true};
+        auto b = pool.pop();
+        std::fill(b.get().begin(), b.get().end(), std::byte{1});
+        REQUIRE(pool.size() == buffers_number-1);
+    }catch(const std::system_error&){
+        SUCCEED("mlock is not permitted");
+    }
+}
+
+TEST_CASE("test_buffer_pool_multithread","[test_buffer_pool]")
+{
+    using bounded_pool::buffer_pool;
+    static constexpr std::size_t buffers_number = 4;
+    static constexpr std::size_t buffer_size = 256;
+    static constexpr std::size_t n_threads = 4;
+    static constexpr std::size_t n_iterations = 10000;
+
+    buffer_pool pool{buffers_number, buffer_size};
+    std::array<std::thread, n_threads> threads{};
+    std::array<bool, n_threads> results{};
+    for (std::size_t i{0}; i!=n_threads; ++i){
+        threads[i] = std::thread{[&pool,&result = results[i],i](){
+            result = true;
+            for (std::size_t j{0}; j!=n_iterations; ++j){
+                auto b = pool.pop_unique();
+                std::fill(b.get().begin(), b.get().end(), static_cast<std::byte>(i));
+                result &= std::all_of(b.get().begin(), b.get().end(), [i](auto v){return v == static_cast<std::byte>(i);});
+            }
+        }};
+    }
+    std::for_each(threads.begin(),threads.end(),[](auto& t){t.join();});
+    REQUIRE(std::all_of(results.begin(),results.end(),[](auto r){return r;}));
+    REQUIRE(pool.size() == buffers_number);
+}
+
+TEST_CASE("test_size_class_pool","[test_buffer_pool]")
+{
+    using bounded_pool::size_class_pool;
+    static constexpr std::size_t small_size = 256;
+    static constexpr std::size_t medium_size = 4*1024;
+    static constexpr std::size_t large_size = 64*1024;
+
+    REQUIRE_THROWS_AS(size_class_pool({}), std::invalid_argument);
+    REQUIRE_THROWS_AS(size_class_pool({{small_size,2},{small_size,4}}), std::invalid_argument);
+
+    size_class_pool pool{{{large_size,1},{small_size,4},{medium_size,2}}};
+    REQUIRE(pool.classes_number() == 3);
+    REQUIRE(pool.stats(0).buffer_size == small_size);
+    REQUIRE(pool.stats(1).buffer_size == medium_size);
+    REQUIRE(pool.stats(2).buffer_size == large_size);
+    REQUIRE_THROWS_AS(pool.pop(large_size+1), std::invalid_argument);
+    //smallest fitting class is selected
+    {
+        auto small = pool.pop(1);
+        auto small1 = pool.try_pop(small_size);
+        auto medium = pool.pop_unique(small_size+1);
+        auto large = pool.try_pop_unique(medium_size+1);
+        REQUIRE(small.get().size() == small_size);
+        REQUIRE(small1.get().size() == small_size);
+        REQUIRE(medium.get().size() == medium_size);
+        REQUIRE(large.get().size() == large_size);
+        REQUIRE(pool.stats(0).idle == 2);
+        REQUIRE(pool.stats(1).idle == 1);
+        REQUIRE(pool.stats(2).idle == 0);
+        //empty class falls back to bigger one
+        auto medium1 = pool.pop(small_size+1);
+        REQUIRE(medium1.get().size() == medium_size);
+        REQUIRE(!pool.try_pop(small_size+1));
+        REQUIRE(!pool.try_pop_unique(medium_size));
+        auto small2 = pool.pop(1);
+        auto small3 = pool.pop(1);
+        auto fallback = pool.try_pop(1);
+        REQUIRE(!fallback);
+    }
+    REQUIRE(pool.stats(0).idle == 4);
+    REQUIRE(pool.stats(1).idle == 2);
+    REQUIRE(pool.stats(2).idle == 1);
+    REQUIRE(pool.stats(0).acquired == 4);
+    REQUIRE(pool.stats(1).acquired == 2);
+    REQUIRE(pool.stats(2).acquired == 1);
+    REQUIRE(pool.stats(0).fallbacks == 0);
+    REQUIRE(pool.stats(1).fallbacks == 0);
+    REQUIRE(pool.stats(2).fallbacks == 0);
+    REQUIRE(pool.stats(1).failures == 2);
+    REQUIRE(pool.stats(0).failures == 1);
+    //fallback to bigger class
+    {
+        std::vector<decltype(pool.pop(1))> buffers{};
+        for (std::size_t i{0}; i!=4; ++i){
+            buffers.push_back(pool.pop(1));
+        }
+        auto b = pool.try_pop(1);
+        REQUIRE(b.get().size() == medium_size);
+        REQUIRE(pool.stats(1).fallbacks == 1);
+        REQUIRE(pool.stats(0).capacity == 4);
+    }
+}
+
+TEST_CASE("test_pool_resource","[test_buffer_pool]")
+{
+    using bounded_pool::pool_resource;
+    using test_buffer_pool::is_aligned;
+    using test_buffer_pool::counting_resource;
+    static constexpr std::size_t blocks_number = 4;
+    static constexpr std::size_t block_size = 250;
+    static constexpr std::size_t alignment = 64;
+
+    REQUIRE_THROWS_AS(pool_resource(blocks_number, block_size, 48), std::invalid_argument);
+    REQUIRE_THROWS_AS(pool_resource(0, block_size), std::invalid_argument);
+
+    counting_resource upstream{};
+    {
+        pool_resource resource{blocks_number, block_size, alignment, &upstream};
+        REQUIRE(resource.block_size() == 256);
+        REQUIRE(resource.blocks_number() == blocks_number);
+        REQUIRE(resource.size() == blocks_number);
+        REQUIRE(resource.upstream_resource() == &upstream);
+        REQUIRE(resource.is_equal(resource));
+        REQUIRE(!resource.is_equal(upstream));
+        //blocks
+        {
+            std::vector<void*> blocks{};
+            for (std::size_t i{0}; i!=blocks_number; ++i){
+                auto p = resource.allocate(i+1, alignment);
+                REQUIRE(is_aligned(p, alignment));
+                blocks.push_back(p);
+            }
+            REQUIRE(resource.size() == 0);
+            REQUIRE(upstream.allocations == 0);
+            //exhausted pool falls back to upstream
+            auto p = resource.allocate(8);
+            REQUIRE(upstream.allocations == 1);
+            resource.deallocate(p, 8);
+            REQUIRE(upstream.deallocations == 1);
+            std::for_each(blocks.begin(),blocks.end(),[&resource](auto p_){resource.deallocate(p_, 1, alignment);});
+            REQUIRE(resource.size() == blocks_number);
+        }
+        //oversize and overaligned requests go to upstream
+        {
+            auto p = resource.allocate(block_size+10);
+            auto p1 = resource.allocate(8, 2*alignment);
+            REQUIRE(upstream.allocations == 3);
+            REQUIRE(resource.size() == blocks_number);
+            resource.deallocate(p, block_size+10);
+            resource.deallocate(p1, 8, 2*alignment);
+            REQUIRE(upstream.deallocations == 3);
+        }
+        //pmr containers
+        {
+            std::pmr::vector<int> v{&resource};
+            v.reserve(16);
+            v.assign(16, 1);
+            std::pmr::string str{"string that does not fit small buffer", &resource};
+            REQUIRE(resource.size() == blocks_number-2);
+            REQUIRE(upstream.allocations == 3);
+            v.resize(100);  //400 bytes do not fit block
+            REQUIRE(upstream.allocations == 4);
+            REQUIRE(resource.size() == blocks_number-1);
+        }
+        REQUIRE(resource.size() == blocks_number);
+        REQUIRE(upstream.deallocations == 4);
+    }
+    //queue allocator
+    {
+        using value_type = std::size_t;
+        using element_type = queue::detail::element_v1_<value_type>;
+        using queue_type = queue::mpmc_bounded_queue_v1<value_type, std::pmr::polymorphic_allocator<element_type>>;
+        static constexpr std::size_t capacity = 4;
+        pool_resource resource{1, capacity*sizeof(element_type), alignof(element_type), &upstream};
+        {
+            queue_type queue{capacity, &resource};
+            REQUIRE(resource.size() == 0);
+            queue.push(value_type{1});
+            REQUIRE(queue.pop().get() == 1);
+        }
+        REQUIRE(resource.size() == 1);
+    }
+    REQUIRE(upstream.allocations == upstream.deallocations);
+}
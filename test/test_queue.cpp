@@ -2,7 +2,9 @@
 #include <thread>
 #include <vector>
 #include <set>
+#include <numeric>
 #include <iostream>
+#include <ctime>
 #include "catch.hpp"
 #include "benchmark_helpers.hpp"
 #include "queue.hpp"
@@ -36,6 +38,9 @@ TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_non_blocking_interface","[test_mpmc_
     (queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_single_thread::value_type>),
     (queue::mpmc_bounded_queue_v2<test_mpmc_bounded_queue_single_thread::value_type>),
     (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_queue_v4<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_elimination_queue<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_stack<test_mpmc_bounded_queue_single_thread::value_type>),
     (queue::st_bounded_queue<test_mpmc_bounded_queue_single_thread::value_type>)
 ){
     using queue_type = TestType;
@@ -102,7 +107,10 @@ TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_non_blocking_interface","[test_mpmc_
 TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_blocking_interface","[test_mpmc_bounded_queue]",
     (queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_single_thread::value_type>),
     (queue::mpmc_bounded_queue_v2<test_mpmc_bounded_queue_single_thread::value_type>),
-    (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::value_type>)
+    (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_queue_v4<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_elimination_queue<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_stack<test_mpmc_bounded_queue_single_thread::value_type>)
 ){
     using queue_type = TestType;
     using value_type = typename queue_type::value_type;
@@ -153,6 +161,9 @@ TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_clear","[test_mpmc_bounded_queue]",
     (queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_single_thread::constructor_destructor_counter>),
     (queue::mpmc_bounded_queue_v2<test_mpmc_bounded_queue_single_thread::constructor_destructor_counter>),
     (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::constructor_destructor_counter>),
+    (queue::mpmc_bounded_queue_v4<test_mpmc_bounded_queue_single_thread::constructor_destructor_counter>),
+    (queue::mpmc_elimination_queue<test_mpmc_bounded_queue_single_thread::constructor_destructor_counter>),
+    (queue::mpmc_bounded_stack<test_mpmc_bounded_queue_single_thread::constructor_destructor_counter>),
     (queue::st_bounded_queue<test_mpmc_bounded_queue_single_thread::constructor_destructor_counter>)
 ){
     using queue_type = TestType;
@@ -214,6 +225,167 @@ TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_clear","[test_mpmc_bounded_queue]",
 }
 
 
+TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_try_pop_n","[test_mpmc_bounded_queue]",
+    (queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_queue_v2<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::st_bounded_queue<test_mpmc_bounded_queue_single_thread::value_type>)
+){
+    using queue_type = TestType;
+    using value_type = typename queue_type::value_type;
+    static constexpr std::size_t capacity = test_mpmc_bounded_queue_single_thread::capacity;
+
+    queue_type queue{capacity};
+    std::vector<value_type> batch(capacity+1, value_type{-1});
+    REQUIRE(queue.try_pop_n(batch.begin(), batch.size()) == 0);
+    for (std::size_t i{0}; i!=10; ++i){
+        queue.try_push(static_cast<value_type>(i));
+    }
+    REQUIRE(queue.try_pop_n(batch.begin(), 0) == 0);
+    REQUIRE(queue.try_pop_n(batch.begin(), 4) == 4);
+    REQUIRE(queue.size() == 6);
+    REQUIRE(std::vector<value_type>(batch.begin(),batch.begin()+5) == std::vector<value_type>{0,1,2,3,-1});
+    REQUIRE(queue.try_pop_n(batch.data(), batch.size()) == 6);
+    REQUIRE(queue.size() == 0);
+    REQUIRE(std::vector<value_type>(batch.begin(),batch.begin()+7) == std::vector<value_type>{4,5,6,7,8,9,-1});
+    //wrap around
+    for (std::size_t i{0}; i!=capacity; ++i){
+        queue.try_push(static_cast<value_type>(i));
+    }
+    REQUIRE(queue.try_pop_n(batch.begin(), batch.size()) == capacity);
+    REQUIRE(queue.size() == 0);
+    std::vector<value_type> expected(capacity);
+    std::iota(expected.begin(),expected.end(),value_type{0});
+    REQUIRE(std::vector<value_type>(batch.begin(),batch.begin()+capacity) == expected);
+}
+
+TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_pop_n","[test_mpmc_bounded_queue]",
+    (queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_queue_v2<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::value_type>),
+    (queue::blocking_queue<queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_single_thread::value_type>>),
+    (queue::blocking_queue<queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::value_type>>)
+){
+    using queue_type = TestType;
+    using value_type = typename queue_type::value_type;
+    static constexpr std::size_t capacity = test_mpmc_bounded_queue_single_thread::capacity;
+
+    queue_type queue{capacity};
+    std::array<value_type, 8> batch{};
+    SECTION("timeout"){
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE(queue.pop_n(batch.begin(), batch.size(), std::chrono::milliseconds(20)) == 0);
+        REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    }
+    SECTION("not_empty"){
+        queue.try_push(value_type{1});
+        queue.try_push(value_type{2});
+        REQUIRE(queue.pop_n(batch.begin(), batch.size(), std::chrono::microseconds(0)) == 2);
+        REQUIRE(batch[0] == 1);
+        REQUIRE(batch[1] == 2);
+    }
+    SECTION("wait_first"){
+        std::thread producer([&queue](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            queue.try_push(value_type{3});
+        });
+        REQUIRE(queue.pop_n(batch.begin(), batch.size(), std::chrono::seconds(10)) == 1);
+        REQUIRE(batch[0] == 3);
+        producer.join();
+    }
+}
+
+TEMPLATE_TEST_CASE("test_blocking_queue","[test_mpmc_bounded_queue]",
+    (queue::blocking_queue<queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_single_thread::value_type>>),
+    (queue::blocking_queue<queue::mpmc_bounded_queue_v2<test_mpmc_bounded_queue_single_thread::value_type>>),
+    (queue::blocking_queue<queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_single_thread::value_type>>)
+){
+    using queue_type = TestType;
+    using value_type = typename queue_type::value_type;
+    static constexpr std::size_t capacity = test_mpmc_bounded_queue_single_thread::capacity;
+
+    queue_type queue{capacity};
+    REQUIRE(queue.capacity() == capacity);
+    REQUIRE(queue.try_push(value_type{1}));
+    REQUIRE(queue.size() == 1);
+    REQUIRE(queue.pop().get() == 1);
+    REQUIRE(!queue.try_pop());
+    std::array<value_type, 8> batch{};
+    //waiting thread uses almost no cpu
+    SECTION("pop_n_waiter_is_parked"){
+        std::thread producer([&queue](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.push(value_type{4});
+        });
+        const auto cpu_start = std::clock();
+        REQUIRE(queue.pop_n(batch.begin(), batch.size(), std::chrono::seconds(10)) == 1);
+        const auto cpu_ms = 1000.0*static_cast<double>(std::clock()-cpu_start)/CLOCKS_PER_SEC;
+        REQUIRE(batch[0] == 4);
+        REQUIRE(cpu_ms < 100);
+        producer.join();
+    }
+    SECTION("pop_waiter_is_parked"){
+        std::thread producer([&queue](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.try_push(value_type{5});
+        });
+        const auto cpu_start = std::clock();
+        value_type v{};
+        queue.pop(v);
+        const auto cpu_ms = 1000.0*static_cast<double>(std::clock()-cpu_start)/CLOCKS_PER_SEC;
+        REQUIRE(v == 5);
+        REQUIRE(cpu_ms < 100);
+        producer.join();
+    }
+}
+
+TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_pop_n_multithread","[test_mpmc_bounded_queue]",
+    (queue::mpmc_bounded_queue_v1<std::size_t>),
+    (queue::mpmc_bounded_queue_v2<std::size_t>),
+    (queue::mpmc_bounded_queue_v3<std::size_t>),
+    (queue::blocking_queue<queue::mpmc_bounded_queue_v1<std::size_t>>)
+){
+    using queue_type = TestType;
+    using value_type = typename queue_type::value_type;
+    static constexpr std::size_t capacity = 64;
+    static constexpr std::size_t batch_size = 16;
+    static constexpr std::size_t n_producers = 4;
+    static constexpr std::size_t n_consumers = 4;
+    static constexpr std::size_t n_elements = 10*1000;
+
+    queue_type queue{capacity};
+    std::array<std::thread, n_producers> producers;
+    std::array<std::thread, n_consumers> consumers;
+    std::array<std::vector<value_type>, n_consumers> results;
+    std::atomic<std::size_t> popped{0};
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumers[i] = std::thread([&queue,&popped,&result = results[i]](){
+            std::array<value_type, batch_size> batch{};
+            while(popped.load() != n_producers*n_elements){
+                auto n = queue.pop_n(batch.begin(), batch.size(), std::chrono::microseconds(100));
+                result.insert(result.end(), batch.begin(), batch.begin()+n);
+                popped.fetch_add(n);
+            }
+        });
+    }
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producers[i] = std::thread([&queue,i](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                queue.push(i*n_elements+j);
+            }
+        });
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    std::for_each(consumers.begin(),consumers.end(),[](auto& t){t.join();});
+    std::vector<value_type> result{};
+    std::for_each(results.begin(),results.end(),[&result](const auto& r){result.insert(result.end(),r.begin(),r.end());});
+    std::sort(result.begin(),result.end());
+    std::vector<value_type> expected(n_producers*n_elements);
+    std::iota(expected.begin(),expected.end(),value_type{0});
+    REQUIRE(result == expected);
+    REQUIRE(queue.size() == 0);
+}
+
 namespace test_mpmc_bounded_queue_multithread{
     using value_type = float;
     static constexpr std::size_t n_elements = 1*1000*1000;
@@ -266,7 +438,10 @@ namespace test_mpmc_bounded_queue_multithread{
 TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_multithread","[test_mpmc_bounded_queue]",
     (queue::mpmc_bounded_queue_v1<test_mpmc_bounded_queue_multithread::value_type>),
     (queue::mpmc_bounded_queue_v2<test_mpmc_bounded_queue_multithread::value_type>),
-    (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_multithread::value_type>)
+    (queue::mpmc_bounded_queue_v3<test_mpmc_bounded_queue_multithread::value_type>),
+    (queue::mpmc_bounded_queue_v4<test_mpmc_bounded_queue_multithread::value_type>),
+    (queue::mpmc_elimination_queue<test_mpmc_bounded_queue_multithread::value_type>),
+    (queue::mpmc_bounded_stack<test_mpmc_bounded_queue_multithread::value_type>)
 )
 {
     using benchmark_helpers::make_ranges;
@@ -308,6 +483,829 @@ TEMPLATE_TEST_CASE("test_mpmc_bounded_queue_multithread","[test_mpmc_bounded_que
     REQUIRE(queue.size() == 0);
 }
 
+namespace test_mpmc_bounded_queue_v4{
+//stalls thread in construction or in move from element until gate is open
+struct gate_type{
+    std::atomic<bool> entered{false};
+    std::atomic<bool> open{false};
+    void pass()const{
+        const_cast<gate_type*>(this)->entered.store(true);
+        while(!open.load()){
+            std::this_thread::yield();
+        }
+    }
+};
+struct value_type{
+    std::size_t value{0};
+    const gate_type* read_gate{nullptr};
+    value_type() = default;
+    value_type(value_type&&) = default;
+    explicit value_type(std::size_t value_, const gate_type* read_gate_ = nullptr):
+        value{value_},
+        read_gate{read_gate_}
+    {}
+    explicit value_type(const gate_type* gate):
+        value{0}
+    {
+        gate->pass();
+    }
+    value_type& operator=(value_type&& other){
+        if (other.read_gate){
+            other.read_gate->pass();
+        }
+        value = other.value;
+        read_gate = nullptr;
+        return *this;
+    }
+};
+}   //end of namespace test_mpmc_bounded_queue_v4
+
+TEST_CASE("test_mpmc_bounded_queue_v4","[test_mpmc_bounded_queue]")
+{
+    using test_mpmc_bounded_queue_v4::gate_type;
+    using value_type = test_mpmc_bounded_queue_v4::value_type;
+    using queue_type = queue::mpmc_bounded_queue_v4<value_type>;
+    static constexpr std::size_t capacity = 2;
+    queue_type queue{capacity};
+    auto wait_entered = [](const gate_type& gate){
+        while(!gate.entered.load()){
+            std::this_thread::yield();
+        }
+    };
+
+    SECTION("ticket_returned_when_full"){
+        REQUIRE(queue.try_push(std::size_t{1}));
+        REQUIRE(queue.try_push(std::size_t{2}));
+        for (std::size_t i{0}; i!=100; ++i){
+            REQUIRE(!queue.try_push(std::size_t{3}));
+        }
+        REQUIRE(queue.try_pop().get().value == 1);
+        REQUIRE(queue.try_push(std::size_t{4}));
+        REQUIRE(queue.try_pop().get().value == 2);
+        REQUIRE(queue.try_pop().get().value == 4);
+        REQUIRE(!queue.try_pop());
+        REQUIRE(queue.size() == 0);
+    }
+    SECTION("slot_being_read_is_skipped"){
+        gate_type gate{};
+        REQUIRE(queue.try_push(std::size_t{0}, &gate));
+        REQUIRE(queue.try_push(std::size_t{1}));
+        value_type read{capacity};
+        std::thread reader{[&queue,&read](){queue.try_pop(read);}};
+        wait_entered(gate);
+        REQUIRE(queue.try_pop().get().value == 1);
+        //producer skips ticket of slot that is being read, consumer marks it unsafe and skips it
+        REQUIRE(queue.try_push(std::size_t{2}));
+        REQUIRE(queue.try_pop().get().value == 2);
+        gate.open.store(true);
+        reader.join();
+        REQUIRE(read.value == 0);
+        //unsafe slot is filled again when no consumer is ahead of producer ticket
+        REQUIRE(queue.try_push(std::size_t{3}));
+        REQUIRE(queue.try_pop().get().value == 3);
+        REQUIRE(queue.size() == 0);
+    }
+    SECTION("reserved_slot_is_skipped"){
+        gate_type gate{};
+        std::thread producer{[&queue,&gate](){queue.try_push(&gate);}};
+        wait_entered(gate);
+        //consumer doesn't wait for producer that constructs element
+        REQUIRE(!queue.try_pop());
+        gate.open.store(true);
+        producer.join();
+        std::size_t failed{0};
+        while(!queue.try_pop()){
+            ++failed;
+        }
+        REQUIRE(failed <= capacity);
+        REQUIRE(queue.try_push(std::size_t{1}));
+        REQUIRE(queue.try_pop().get().value == 1);
+        REQUIRE(queue.size() == 0);
+    }
+    SECTION("state_fixed_after_failed_pushes"){
+        static constexpr std::size_t n_producers = 4;
+        REQUIRE(queue.try_push(std::size_t{0}));
+        REQUIRE(queue.try_push(std::size_t{1}));
+        //tickets of failed pushes may be not returned under contention
+        std::atomic<std::size_t> pushed{0};
+        std::array<std::thread, n_producers> producers;
+        for (auto& producer : producers){
+            producer = std::thread{[&queue,&pushed](){
+                for (std::size_t i{0}; i!=1000; ++i){
+                    if (queue.try_push(std::size_t{2})){
+                        pushed.fetch_add(1);
+                    }
+                }
+            }};
+        }
+        std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+        REQUIRE(pushed.load() == 0);
+        REQUIRE(queue.try_pop().get().value == 0);
+        REQUIRE(queue.try_pop().get().value == 1);
+        REQUIRE(!queue.try_pop());
+        REQUIRE(queue.size() == 0);
+        //consumers passed tickets of failed pushes and tail is pulled up to head
+        for (std::size_t i{0}; i!=2*capacity; ++i){
+            REQUIRE(queue.try_push(i));
+            REQUIRE(queue.try_pop().get().value == i);
+        }
+        REQUIRE(queue.size() == 0);
+    }
+}
+
+TEST_CASE("test_mpmc_bounded_stack","[test_mpmc_bounded_stack]")
+{
+    using value_type = std::size_t;
+    using stack_type = queue::mpmc_bounded_stack<value_type>;
+    static constexpr std::size_t capacity = 8;
+
+    stack_type stack{capacity};
+    REQUIRE(stack.capacity() == capacity);
+    REQUIRE(stack.size() == 0);
+    REQUIRE(!stack.try_pop());
+    for (std::size_t i{0}; i!=capacity; ++i){
+        REQUIRE(stack.try_push(i));
+    }
+    REQUIRE(!stack.try_push(value_type{0}));
+    REQUIRE(stack.size() == capacity);
+    value_type v{};
+    for (std::size_t i{capacity}; i!=0; --i){
+        REQUIRE(stack.try_pop(v));
+        REQUIRE(v == i-1);
+    }
+    REQUIRE(stack.size() == 0);
+    REQUIRE(!stack.try_pop(v));
+    //interleaved
+    stack.push(value_type{1});
+    stack.push(value_type{2});
+    REQUIRE(stack.pop().get() == 2);
+    stack.push(value_type{3});
+    REQUIRE(stack.pop().get() == 3);
+    REQUIRE(stack.pop().get() == 1);
+    REQUIRE(stack.size() == 0);
+}
+
+TEST_CASE("test_try_pop_exactly","[test_mpmc_bounded_stack]")
+{
+    using value_type = std::size_t;
+    static constexpr std::size_t capacity = 8;
+    std::vector<value_type> result{};
+    SECTION("stack"){
+        queue::mpmc_bounded_stack<value_type> stack{capacity};
+        for (std::size_t i{0}; i!=capacity-2; ++i){
+            stack.push(i);
+        }
+        REQUIRE(!stack.try_pop_exactly(std::back_inserter(result), capacity-1));
+        REQUIRE(stack.size() == capacity-2);
+        REQUIRE(stack.try_pop_exactly(std::back_inserter(result), 3));
+        REQUIRE(result == std::vector<value_type>{5,4,3});
+        REQUIRE(stack.size() == capacity-5);
+        //popped slots are returned to free list at once
+        for (std::size_t i{0}; i!=5; ++i){
+            REQUIRE(stack.try_push(i+10));
+        }
+        REQUIRE(!stack.try_push(value_type{0}));
+        result.clear();
+        stack.pop_exactly(std::back_inserter(result), capacity);
+        REQUIRE(result == std::vector<value_type>{14,13,12,11,10,2,1,0});
+        REQUIRE(stack.size() == 0);
+    }
+    SECTION("pointer_queue"){
+        std::vector<value_type> values(capacity);
+        std::iota(values.begin(),values.end(),value_type{0});
+        queue::mpmc_bounded_pointer_queue<value_type> queue{capacity};
+        std::for_each(values.begin(),values.end()-2,[&queue](auto& v){queue.push(&v);});
+        std::vector<value_type*> popped{};
+        REQUIRE(!queue.try_pop_exactly(std::back_inserter(popped), capacity-1));
+        REQUIRE(queue.size() == capacity-2);
+        REQUIRE(queue.try_pop_exactly(std::back_inserter(popped), 3));
+        queue.pop_exactly(std::back_inserter(popped), 3);
+        REQUIRE(queue.size() == 0);
+        std::for_each(popped.begin(),popped.end(),[&result](auto p){result.push_back(*p);});
+        REQUIRE(result == std::vector<value_type>{0,1,2,3,4,5});
+    }
+}
+
+TEST_CASE("test_mpmc_bounded_pointer_queue","[test_mpmc_bounded_pointer_queue]")
+{
+    using value_type = std::size_t;
+    using queue_type = queue::mpmc_bounded_pointer_queue<value_type>;
+    static constexpr std::size_t capacity = 8;
+
+    std::array<value_type, capacity> values{};
+    std::iota(values.begin(),values.end(),value_type{0});
+    queue_type queue{capacity};
+    REQUIRE(queue.capacity() == capacity);
+    REQUIRE(queue.size() == 0);
+    REQUIRE(queue.try_pop() == nullptr);
+    value_type* v{nullptr};
+    REQUIRE(!queue.try_pop(v));
+    for (auto& value : values){
+        REQUIRE(queue.try_push(&value));
+    }
+    REQUIRE(!queue.try_push(&values[0]));
+    REQUIRE(queue.size() == capacity);
+    for (auto& value : values){
+        REQUIRE(queue.try_pop(v));
+        REQUIRE(v == &value);
+    }
+    REQUIRE(queue.size() == 0);
+    REQUIRE(queue.try_pop() == nullptr);
+    for (auto& value : values){
+        queue.push(&value);
+    }
+    for (auto& value : values){
+        REQUIRE(queue.pop() == &value);
+    }
+    REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE("test_mpmc_bounded_pointer_queue_multithread","[test_mpmc_bounded_pointer_queue]")
+{
+    using value_type = std::size_t;
+    using queue_type = queue::mpmc_bounded_pointer_queue<value_type>;
+    static constexpr std::size_t capacity = 16;
+    static constexpr std::size_t n_producers = 4;
+    static constexpr std::size_t n_consumers = 4;
+    static constexpr std::size_t n_elements = 10*1000;
+
+    std::vector<value_type> values(n_producers*n_elements);
+    std::iota(values.begin(),values.end(),value_type{0});
+    queue_type queue{capacity};
+    std::array<std::thread, n_producers> producers;
+    std::array<std::thread, n_consumers> consumers;
+    std::array<std::vector<value_type>, n_consumers> results;
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumers[i] = std::thread([&queue,&result = results[i]](){
+            for (std::size_t j{0}; j!=n_producers*n_elements/n_consumers; ++j){
+                if (j%2){
+                    result.push_back(*queue.pop());
+                }else{
+                    value_type* v{nullptr};
+                    while(!queue.try_pop(v)){
+                        std::this_thread::yield();
+                    }
+                    result.push_back(*v);
+                }
+            }
+        });
+    }
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producers[i] = std::thread([&queue,&values,i](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                auto p = &values[i*n_elements+j];
+                if (j%2){
+                    queue.push(p);
+                }else{
+                    while(!queue.try_push(p)){
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    std::for_each(consumers.begin(),consumers.end(),[](auto& t){t.join();});
+    std::vector<value_type> result{};
+    std::for_each(results.begin(),results.end(),[&result](const auto& r){result.insert(result.end(),r.begin(),r.end());});
+    std::sort(result.begin(),result.end());
+    REQUIRE(result == values);
+    REQUIRE(queue.size() == 0);
+}
+
+//threads pop element and push it back, so blocking pops reserve tickets ahead of producer that is preempted after reserving its ticket
+TEST_CASE("test_mpmc_bounded_pointer_queue_pop_push_multithread","[test_mpmc_bounded_pointer_queue]")
+{
+    using value_type = std::size_t;
+    using queue_type = queue::mpmc_bounded_pointer_queue<value_type>;
+    static constexpr std::size_t capacity = 16;
+    static constexpr std::size_t n_threads = 4;
+    static constexpr std::size_t n_iterations = 100*1000;
+
+    std::vector<value_type> values(capacity, value_type{0});
+    queue_type queue{capacity};
+    std::for_each(values.begin(),values.end(),[&queue](auto& v){queue.push(&v);});
+    std::array<std::thread, n_threads> threads;
+    for (auto& t : threads){
+        t = std::thread([&queue](){
+            for (std::size_t j{0}; j!=n_iterations; ++j){
+                auto v = queue.pop();
+                ++*v;
+                queue.push(v);
+            }
+        });
+    }
+    std::for_each(threads.begin(),threads.end(),[](auto& t){t.join();});
+    REQUIRE(queue.size() == capacity);
+    REQUIRE(std::accumulate(values.begin(),values.end(),value_type{0}) == n_threads*n_iterations);
+}
+
+TEST_CASE("test_spmc_bounded_deque","[test_spmc_bounded_deque]")
+{
+    using value_type = std::size_t;
+    using deque_type = queue::spmc_bounded_deque<value_type>;
+
+    REQUIRE_THROWS_AS(deque_type{0}, std::invalid_argument);
+    REQUIRE(deque_type{5}.capacity() == 8);
+
+    static constexpr std::size_t capacity = 8;
+    std::array<value_type, capacity> values{};
+    std::iota(values.begin(),values.end(),value_type{0});
+    deque_type deque{capacity};
+    REQUIRE(deque.capacity() == capacity);
+    REQUIRE(deque.size() == 0);
+    REQUIRE(deque.try_pop() == nullptr);
+    REQUIRE(deque.try_steal() == nullptr);
+    for (auto& value : values){
+        REQUIRE(deque.try_push(&value));
+    }
+    REQUIRE(!deque.try_push(&values[0]));
+    REQUIRE(deque.size() == capacity);
+    //owner pops LIFO, thief steals FIFO
+    REQUIRE(deque.try_pop() == &values[7]);
+    REQUIRE(deque.try_steal() == &values[0]);
+    REQUIRE(deque.try_pop() == &values[6]);
+    REQUIRE(deque.try_steal() == &values[1]);
+    REQUIRE(deque.size() == capacity-4);
+    //wrap around
+    REQUIRE(deque.try_push(&values[6]));
+    REQUIRE(deque.try_push(&values[7]));
+    for (auto it = values.rbegin(); it!=values.rend()-2; ++it){
+        REQUIRE(deque.try_pop() == &*it);
+    }
+    REQUIRE(deque.size() == 0);
+    REQUIRE(deque.try_pop() == nullptr);
+    REQUIRE(deque.try_steal() == nullptr);
+}
+
+TEST_CASE("test_spmc_bounded_deque_multithread","[test_spmc_bounded_deque]")
+{
+    using value_type = std::size_t;
+    using deque_type = queue::spmc_bounded_deque<value_type>;
+    static constexpr std::size_t capacity = 16;
+    static constexpr std::size_t n_thieves = 4;
+    static constexpr std::size_t n_elements = 100*1000;
+
+    std::vector<value_type> values(n_elements);
+    std::iota(values.begin(),values.end(),value_type{0});
+    deque_type deque{capacity};
+    std::atomic<bool> finish{false};
+    std::array<std::thread, n_thieves> thieves;
+    std::array<std::vector<value_type>, n_thieves+1> results;
+    for (std::size_t i{0}; i!=n_thieves; ++i){
+        thieves[i] = std::thread([&deque,&finish,&result = results[i]](){
+            while(!finish.load() || deque.size() != 0){
+                if (auto p = deque.try_steal()){
+                    result.push_back(*p);
+                }else{
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    //owner pushes and pops every third element back
+    auto& owner_result = results[n_thieves];
+    for (std::size_t j{0}; j!=n_elements; ++j){
+        while(!deque.try_push(&values[j])){
+            std::this_thread::yield();
+        }
+        if (j%3 == 0){
+            if (auto p = deque.try_pop()){
+                owner_result.push_back(*p);
+            }
+        }
+    }
+    finish.store(true);
+    std::for_each(thieves.begin(),thieves.end(),[](auto& t){t.join();});
+    std::vector<value_type> result{};
+    std::for_each(results.begin(),results.end(),[&result](const auto& r){result.insert(result.end(),r.begin(),r.end());});
+    std::sort(result.begin(),result.end());
+    REQUIRE(result == values);
+    REQUIRE(deque.size() == 0);
+}
+
+TEST_CASE("test_mpmc_overwriting_queue","[test_mpmc_overwriting_queue]")
+{
+    using value_type = std::size_t;
+    using queue_type = queue::mpmc_overwriting_queue<value_type>;
+    static constexpr std::size_t capacity = 64;
+    queue_type queue{capacity};
+    REQUIRE(queue.size() == 0);
+    REQUIRE(!queue.try_pop());
+
+    SECTION("not_full_queue"){
+        for (std::size_t i{0}; i!=capacity; ++i){
+            queue.push(i);
+        }
+        REQUIRE(queue.size() == capacity);
+        std::vector<value_type> result{};
+        value_type v{};
+        while(queue.try_pop(v)){
+            result.push_back(v);
+        }
+        std::vector<value_type> expected(capacity);
+        std::iota(expected.begin(),expected.end(),value_type{0});
+        REQUIRE(result == expected);
+        REQUIRE(queue.size() == 0);
+        REQUIRE(queue.overwritten() == 0);
+    }
+    SECTION("overwrite_oldest"){
+        static constexpr std::size_t n_elements = 3*capacity+10;
+        for (std::size_t i{0}; i!=n_elements; ++i){
+            queue.push(i);
+        }
+        REQUIRE(queue.size() == capacity);
+        std::vector<value_type> result{};
+        while(auto e = queue.try_pop()){
+            result.push_back(e.get());
+        }
+        std::vector<value_type> expected(capacity);
+        std::iota(expected.begin(),expected.end(),value_type{n_elements-capacity});
+        REQUIRE(result == expected);
+        REQUIRE(queue.size() == 0);
+        REQUIRE(queue.overwritten() == n_elements-capacity);
+        queue.push(n_elements);
+        REQUIRE(queue.pop().get() == n_elements);
+    }
+}
+
+namespace test_mpmc_overwriting_queue_multithread{
+struct value_type{
+    std::size_t producer;
+    std::size_t number;
+    bool operator<(const value_type& other)const{return producer < other.producer || (producer == other.producer && number < other.number);}
+};
+}   //end of namespace test_mpmc_overwriting_queue_multithread
+
+TEST_CASE("test_mpmc_overwriting_queue_multithread","[test_mpmc_overwriting_queue]")
+{
+    using value_type = test_mpmc_overwriting_queue_multithread::value_type;
+    using queue_type = queue::mpmc_overwriting_queue<value_type>;
+    static constexpr std::size_t capacity = 32;
+    static constexpr std::size_t n_producers = 4;
+    static constexpr std::size_t n_consumers = 4;
+    static constexpr std::size_t n_elements = 100*1000;
+    queue_type queue{capacity};
+
+    std::atomic<bool> producers_done{false};
+    std::array<std::thread, n_producers> producers;
+    std::array<std::thread, n_consumers> consumers;
+    std::array<std::vector<value_type>, n_consumers> results;
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producers[i] = std::thread([&queue,i](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                queue.push(i,j);
+            }
+        });
+    }
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumers[i] = std::thread([&queue,&producers_done,&result = results[i]](){
+            value_type v{};
+            while(true){
+                if (queue.try_pop(v)){
+                    result.push_back(v);
+                }else if (producers_done.load()){
+                    if (!queue.try_pop(v)){
+                        break;
+                    }
+                    result.push_back(v);
+                }else{
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    producers_done.store(true);
+    std::for_each(consumers.begin(),consumers.end(),[](auto& t){t.join();});
+
+    std::size_t n_popped{0};
+    std::set<value_type> popped{};
+    for (const auto& result : results){
+        //elements of every producer are popped by single consumer in order they were pushed
+        std::array<std::size_t, n_producers> last{};
+        for (const auto& v : result){
+            REQUIRE(v.producer < n_producers);
+            REQUIRE(v.number < n_elements);
+            REQUIRE(v.number+1 > last[v.producer]);
+            last[v.producer] = v.number+1;
+        }
+        n_popped+=result.size();
+        popped.insert(result.begin(),result.end());
+    }
+    REQUIRE(popped.size() == n_popped);
+    REQUIRE(n_popped + queue.overwritten() == n_producers*n_elements);
+    REQUIRE(queue.size() == 0);
+}
+
+namespace test_mpmc_overwriting_queue_lapping{
+//construction waits until gate is open, to stall producer while its push is in progress
+struct value_type{
+    std::size_t value;
+    value_type() = default;
+    explicit value_type(std::size_t value_):
+        value{value_}
+    {}
+    explicit value_type(const std::atomic<bool>* gate):
+        value{0}
+    {
+        while(!gate->load()){
+            std::this_thread::yield();
+        }
+    }
+};
+}   //end of namespace test_mpmc_overwriting_queue_lapping
+
+TEST_CASE("test_mpmc_overwriting_queue_lapping","[test_mpmc_overwriting_queue]")
+{
+    using value_type = test_mpmc_overwriting_queue_lapping::value_type;
+    using queue_type = queue::mpmc_overwriting_queue<value_type>;
+    static constexpr std::size_t capacity = 4;
+    queue_type queue{capacity};
+
+    std::atomic<bool> gate{false};
+    std::thread stalled{[&queue,&gate](){queue.push(&gate);}};
+    while(queue.size() == 0){
+        std::this_thread::yield();
+    }
+    //pushes that lap stalled push on its element are abandoned, not waiting
+    for (std::size_t i{1}; i!=2*capacity+1; ++i){
+        queue.push(i);
+    }
+    gate.store(true);
+    stalled.join();
+    std::vector<std::size_t> result{};
+    while(auto e = queue.try_pop()){
+        result.push_back(e.get().value);
+    }
+    REQUIRE(result == std::vector<std::size_t>{5,6,7});
+    REQUIRE(queue.overwritten() == 6);
+    //element is free after stalled push is done
+    queue.push(std::size_t{9});
+    REQUIRE(queue.pop().get().value == 9);
+}
+
+TEMPLATE_TEST_CASE("test_queue_set","[test_queue_set]",
+    (queue::mpmc_bounded_queue_v1<std::size_t>),
+    (queue::mpmc_bounded_queue_v2<std::size_t>)
+)
+{
+    using queue_type = TestType;
+    using value_type = typename queue_type::value_type;
+    using set_type = queue::queue_set<queue_type>;
+    static constexpr std::size_t capacity = 16;
+    queue_type q0{capacity}, q1{capacity}, q2{capacity}, q3{capacity};
+    set_type set{};
+    value_type v{};
+    REQUIRE(set.try_pop(v) == set_type::npos);
+
+    SECTION("round_robin"){
+        auto id0 = set.add(q0);
+        auto id1 = set.add(q1);
+        auto id2 = set.add(q2);
+        REQUIRE(set.members_number() == 3);
+        for (std::size_t i{0}; i!=3; ++i){
+            set.push(id0, i);
+            set.push(id1, i);
+            set.push(id2, i);
+        }
+        REQUIRE(set.size() == 9);
+        std::vector<std::size_t> ids{};
+        while(true){
+            auto id = set.try_pop(v);
+            if (id == set_type::npos){
+                break;
+            }
+            ids.push_back(id);
+        }
+        REQUIRE(ids == std::vector<std::size_t>{id0,id1,id2,id0,id1,id2,id0,id1,id2});
+        REQUIRE(set.size() == 0);
+    }
+    SECTION("priority"){
+        auto id0 = set.add(q0,0);
+        auto id1 = set.add(q1,2);
+        auto id2 = set.add(q2,1);
+        auto id3 = set.add(q3,2);
+        REQUIRE(set.try_push(id0, value_type{0}));
+        REQUIRE(set.try_push(id2, value_type{2}));
+        REQUIRE(set.try_push(id1, value_type{1}));
+        REQUIRE(set.try_push(id3, value_type{3}));
+        REQUIRE(set.try_push(id1, value_type{1}));
+        std::vector<std::size_t> ids{};
+        while(true){
+            auto id = set.try_pop(v);
+            if (id == set_type::npos){
+                break;
+            }
+            REQUIRE(v == id);
+            ids.push_back(id);
+        }
+        REQUIRE(ids == std::vector<std::size_t>{id1,id3,id1,id2,id0});
+    }
+}
+
+TEST_CASE("test_queue_set_multithread","[test_queue_set]")
+{
+    using queue_type = queue::mpmc_bounded_queue_v1<std::size_t>;
+    using set_type = queue::queue_set<queue_type>;
+    static constexpr std::size_t capacity = 16;
+    static constexpr std::size_t n_queues = 8;
+    static constexpr std::size_t n_consumers = 2;
+    static constexpr std::size_t n_elements = 10*1000;
+
+    std::vector<std::unique_ptr<queue_type>> queues{};
+    set_type set{};
+    for (std::size_t i{0}; i!=n_queues; ++i){
+        queues.push_back(std::make_unique<queue_type>(capacity));
+        set.add(*queues.back(), i%2);
+    }
+    std::array<std::thread, n_queues> producers;
+    std::array<std::thread, n_consumers> consumers;
+    std::array<std::vector<std::size_t>, n_consumers> results;
+    std::atomic<std::size_t> wrong_ids{0};
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumers[i] = std::thread([&set,&wrong_ids,&result = results[i]](){
+            std::size_t v{};
+            for (std::size_t j{0}; j!=n_queues*n_elements/n_consumers; ++j){
+                if (set.pop(v) != v/n_elements){
+                    ++wrong_ids;
+                }
+                result.push_back(v);
+            }
+        });
+    }
+    for (std::size_t i{0}; i!=n_queues; ++i){
+        producers[i] = std::thread([&set,i](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                if (j%2){
+                    set.push(i, i*n_elements+j);
+                }else{
+                    while(!set.try_push(i, i*n_elements+j)){
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    std::for_each(consumers.begin(),consumers.end(),[](auto& t){t.join();});
+    REQUIRE(wrong_ids.load() == 0);
+    std::vector<std::size_t> result{};
+    std::for_each(results.begin(),results.end(),[&result](const auto& r){result.insert(result.end(),r.begin(),r.end());});
+    std::sort(result.begin(),result.end());
+    std::vector<std::size_t> expected(n_queues*n_elements);
+    std::iota(expected.begin(),expected.end(),std::size_t{0});
+    REQUIRE(result == expected);
+    REQUIRE(set.size() == 0);
+}
+
+TEST_CASE("test_channel","[test_channel]")
+{
+    using value_type = std::size_t;
+    using channel_type = queue::channel<value_type>;
+
+    SECTION("buffered"){
+        channel_type ch{3};
+        REQUIRE(ch.capacity() == 3);
+        REQUIRE(!ch.closed());
+        REQUIRE(!ch.try_recv());
+        REQUIRE(ch.try_send(value_type{1}));
+        REQUIRE(ch.send(value_type{2}));
+        REQUIRE(ch.try_send(value_type{3}));
+        REQUIRE(!ch.try_send(value_type{4}));
+        REQUIRE(ch.size() == 3);
+        value_type v{};
+        REQUIRE(ch.try_recv(v));
+        REQUIRE(v == 1);
+        ch.close();
+        REQUIRE(ch.closed());
+        REQUIRE(!ch.send(value_type{4}));
+        REQUIRE(!ch.try_send(value_type{4}));
+        REQUIRE(ch.recv(v));
+        REQUIRE(v == 2);
+        auto e = ch.recv();
+        REQUIRE(e);
+        REQUIRE(e.get() == 3);
+        REQUIRE(!ch.recv(v));
+        REQUIRE(!ch.recv());
+    }
+    SECTION("range_for"){
+        channel_type ch{8};
+        for (value_type i{0}; i!=5; ++i){
+            ch.send(i);
+        }
+        ch.close();
+        std::vector<value_type> result{};
+        for (auto& v : ch){
+            result.push_back(v);
+        }
+        REQUIRE(result == std::vector<value_type>{0,1,2,3,4});
+    }
+    SECTION("rendezvous"){
+        channel_type ch{};
+        REQUIRE(ch.capacity() == 0);
+        REQUIRE(!ch.try_send(value_type{1}));  //no waiting receiver
+        REQUIRE(!ch.try_recv());
+        std::atomic<bool> sent{false};
+        std::thread sender([&ch,&sent](){
+            ch.send(value_type{1});
+            sent.store(true);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(!sent.load());  //no receiver yet
+        value_type v{};
+        REQUIRE(ch.recv(v));
+        REQUIRE(v == 1);
+        sender.join();
+        REQUIRE(sent.load());
+        REQUIRE(ch.size() == 0);
+    }
+    SECTION("rendezvous_try_send"){
+        channel_type ch{};
+        std::vector<value_type> result{};
+        std::thread receiver([&ch,&result](){
+            for (std::size_t i{0}; i!=3; ++i){
+                result.push_back(ch.recv().get());
+            }
+        });
+        //try_send doesn't wait until blocked receiver takes element, next send waits for both elements
+        while(!ch.try_send(value_type{1})){
+            std::this_thread::yield();
+        }
+        REQUIRE(ch.send(value_type{2}));
+        REQUIRE(ch.send(value_type{3}));
+        receiver.join();
+        REQUIRE(result == std::vector<value_type>{1,2,3});
+        REQUIRE(ch.size() == 0);
+        REQUIRE(!ch.try_send(value_type{4}));
+    }
+    SECTION("close_wakes_blocked"){
+        channel_type ch{};
+        std::atomic<std::size_t> results{0};
+        std::thread receiver([&ch,&results](){
+            if (!ch.recv()){
+                ++results;
+            }
+        });
+        std::thread sender([&ch,&results](){
+            if (!ch.send(value_type{1})){
+                ++results;
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ch.close();
+        receiver.join();
+        sender.join();
+        //either element passed from sender to receiver before close or both get false
+        REQUIRE((results.load() == 0 || results.load() == 2));
+    }
+}
+
+TEMPLATE_TEST_CASE("test_channel_multithread","[test_channel]",
+    (std::integral_constant<std::size_t,0>),
+    (std::integral_constant<std::size_t,1>),
+    (std::integral_constant<std::size_t,64>)
+)
+{
+    using value_type = std::size_t;
+    using channel_type = queue::channel<value_type>;
+    static constexpr std::size_t n_producers = 4;
+    static constexpr std::size_t n_consumers = 4;
+    static constexpr std::size_t n_elements = 10*1000;
+
+    channel_type ch{TestType::value};
+    std::array<std::thread, n_producers> producers;
+    std::array<std::thread, n_consumers> consumers;
+    std::array<std::vector<value_type>, n_consumers> results;
+    std::atomic<std::size_t> failed_sends{0};
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumers[i] = std::thread([&ch,&result = results[i]](){
+            for (const auto& v : ch){
+                result.push_back(v);
+            }
+        });
+    }
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producers[i] = std::thread([&ch,&failed_sends,i](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                if (!ch.send(i*n_elements+j)){
+                    ++failed_sends;
+                }
+            }
+        });
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    ch.close();
+    std::for_each(consumers.begin(),consumers.end(),[](auto& t){t.join();});
+    REQUIRE(failed_sends.load() == 0);
+    std::vector<value_type> result{};
+    std::for_each(results.begin(),results.end(),[&result](const auto& r){result.insert(result.end(),r.begin(),r.end());});
+    std::sort(result.begin(),result.end());
+    std::vector<value_type> expected(n_producers*n_elements);
+    std::iota(expected.begin(),expected.end(),value_type{0});
+    REQUIRE(result == expected);
+}
+
 namespace test_st_queue_of_polymorphic{
 
 inline constexpr std::size_t neg_alignment = 1024;
@@ -476,3 +1474,124 @@ TEST_CASE("test_st_queue_of_polymorphic", "[test_st_queue_of_polymorphic]"){
         REQUIRE(ctr_dtr_counter<binary_mul<value_type>>::ctr_counter() == 2);
     }
 }
+
+TEST_CASE("test_mpsc_queue_of_polymorphic", "[test_mpsc_queue_of_polymorphic]"){
+    using queue::mpsc_queue_of_polymorphic;
+    using test_st_queue_of_polymorphic::operation;
+    using test_st_queue_of_polymorphic::neg;
+    using test_st_queue_of_polymorphic::binary_add;
+    using test_st_queue_of_polymorphic::binary_mul;
+    using test_st_queue_of_polymorphic::neg_alignment;
+    using test_st_queue_of_polymorphic::ctr_dtr_counter;
+    using value_type = int;
+
+    ctr_dtr_counter<neg<value_type>>::reset_counters();
+    ctr_dtr_counter<binary_add<value_type>>::reset_counters();
+    ctr_dtr_counter<binary_mul<value_type>>::reset_counters();
+
+    mpsc_queue_of_polymorphic<operation<value_type>> queue{};
+    REQUIRE(!queue.try_pop());
+
+    SECTION("test_single_element"){
+        auto neg_elem = queue.make<neg<value_type>>(1);
+        REQUIRE(neg_elem);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(&neg_elem.get())%neg_alignment == 0);
+        REQUIRE(neg_elem->call() == -1);
+        REQUIRE(!queue.try_pop());
+        queue.push(std::move(neg_elem));
+        REQUIRE(!neg_elem);
+        REQUIRE(ctr_dtr_counter<neg<value_type>>::ctr_counter() == 1);
+        REQUIRE(ctr_dtr_counter<neg<value_type>>::dtr_counter() == 0);
+        {
+            auto neg_op = queue.try_pop();
+            REQUIRE(neg_op);
+            REQUIRE(neg_op->call() == -1);
+            REQUIRE(!queue.try_pop());
+        }
+        REQUIRE(ctr_dtr_counter<neg<value_type>>::dtr_counter() == 1);
+        //not pushed element is destroyed by wrapper
+        {
+            auto neg_elem_ = queue.make<neg<value_type>>(2);
+        }
+        REQUIRE(ctr_dtr_counter<neg<value_type>>::ctr_counter() == 2);
+        REQUIRE(ctr_dtr_counter<neg<value_type>>::dtr_counter() == 2);
+    }
+    SECTION("test_many_elements"){
+        static constexpr std::size_t n_iters = 1000;
+        std::vector<value_type> expected{};
+        std::vector<value_type> result{};
+        for (std::size_t i{0}; i!=n_iters; ++i){
+            queue.push<neg<value_type>>(static_cast<value_type>(i));
+            expected.push_back(-static_cast<value_type>(i));
+            queue.push<binary_add<value_type>>(static_cast<value_type>(i),2);
+            expected.push_back(static_cast<value_type>(i)+2);
+            if (i%3 == 0){
+                while(auto elem = queue.try_pop()){
+                    result.push_back(elem->call());
+                }
+            }
+            queue.push<binary_mul<value_type>>(2,static_cast<value_type>(i));
+            expected.push_back(2*static_cast<value_type>(i));
+        }
+        while(auto elem = queue.try_pop()){
+            result.push_back(elem->call());
+        }
+        REQUIRE(result == expected);
+        REQUIRE(ctr_dtr_counter<neg<value_type>>::dtr_counter() == n_iters);
+        REQUIRE(ctr_dtr_counter<binary_add<value_type>>::dtr_counter() == n_iters);
+        REQUIRE(ctr_dtr_counter<binary_mul<value_type>>::dtr_counter() == n_iters);
+    }
+    SECTION("test_clear_queue_on_destruction"){
+        {
+            mpsc_queue_of_polymorphic<operation<value_type>> queue_{};
+            queue_.push<neg<value_type>>(1);
+            queue_.push<binary_add<value_type>>(1,2);
+            queue_.push<binary_mul<value_type>>(2,1);
+            queue_.try_pop();
+        }
+        REQUIRE(ctr_dtr_counter<neg<value_type>>::dtr_counter() == 1);
+        REQUIRE(ctr_dtr_counter<binary_add<value_type>>::dtr_counter() == 1);
+        REQUIRE(ctr_dtr_counter<binary_mul<value_type>>::dtr_counter() == 1);
+    }
+}
+
+TEST_CASE("test_mpsc_queue_of_polymorphic_multithread", "[test_mpsc_queue_of_polymorphic]"){
+    using queue::mpsc_queue_of_polymorphic;
+    using test_st_queue_of_polymorphic::operation;
+    using test_st_queue_of_polymorphic::binary_add;
+    using value_type = int;
+    static constexpr std::size_t n_producers = 4;
+    static constexpr std::size_t n_elements = 10*1000;
+
+    mpsc_queue_of_polymorphic<operation<value_type>> queue{};
+    std::array<std::thread, n_producers> producers;
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producers[i] = std::thread([&queue,i](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                queue.push<binary_add<value_type>>(static_cast<value_type>(i*n_elements), static_cast<value_type>(j));
+            }
+        });
+    }
+    std::vector<value_type> result{};
+    std::array<value_type, n_producers> last{};
+    last.fill(-1);
+    bool is_fifo{true};
+    while(result.size() != n_producers*n_elements){
+        if (auto elem = queue.try_pop()){
+            auto v = elem->call();
+            auto& last_ = last[static_cast<std::size_t>(v)/n_elements];
+            is_fifo = is_fifo && last_ < v;
+            last_ = v;
+            result.push_back(v);
+        }else{
+            std::this_thread::yield();
+        }
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    REQUIRE(is_fifo);
+    REQUIRE(!queue.try_pop());
+    std::sort(result.begin(),result.end());
+    std::vector<value_type> expected(n_producers*n_elements);
+    std::iota(expected.begin(),expected.end(),value_type{0});
+    REQUIRE(result == expected);
+}
@@ -0,0 +1,172 @@
+#include <thread>
+#include <vector>
+#include <array>
+#include <numeric>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "catch.hpp"
+#include "spilling_queue.hpp"
+
+namespace test_spilling_queue{
+
+inline auto journal_file_name(){
+    return (std::filesystem::temp_directory_path()/"test_spilling_queue.journal").string();
+}
+
+}   //end of namespace test_spilling_queue
+
+TEST_CASE("test_mpmc_spilling_queue","[test_mpmc_spilling_queue]")
+{
+    using value_type = std::size_t;
+    using queue_type = queue::mpmc_spilling_queue<value_type>;
+    static constexpr std::size_t capacity = 8;
+    static constexpr std::size_t journal_capacity = 4;
+    queue_type queue{capacity, test_spilling_queue::journal_file_name(), journal_capacity};
+    REQUIRE(queue.size() == 0);
+    REQUIRE(queue.spilled() == 0);
+    REQUIRE(!queue.try_pop());
+
+    SECTION("not_full_queue"){
+        for (std::size_t i{0}; i!=capacity; ++i){
+            queue.push(i);
+        }
+        REQUIRE(queue.size() == capacity);
+        REQUIRE(queue.spilled() == 0);
+        std::vector<value_type> result{};
+        value_type v{};
+        while(queue.try_pop(v)){
+            result.push_back(v);
+        }
+        std::vector<value_type> expected(capacity);
+        std::iota(expected.begin(),expected.end(),value_type{0});
+        REQUIRE(result == expected);
+    }
+    SECTION("spill_and_replay"){
+        static constexpr std::size_t n_elements = 10*capacity;
+        for (std::size_t i{0}; i!=n_elements; ++i){
+            queue.push(i);
+        }
+        REQUIRE(queue.size() == n_elements);
+        REQUIRE(queue.spilled() == n_elements-capacity);
+        //pop some elements and push more, spilled elements must be popped before newly pushed
+        std::vector<value_type> result{};
+        for (std::size_t i{0}; i!=capacity/2; ++i){
+            result.push_back(queue.pop().get());
+        }
+        for (std::size_t i{n_elements}; i!=n_elements+capacity; ++i){
+            queue.push(i);
+        }
+        REQUIRE(queue.spilled() == n_elements);
+        while(auto e = queue.try_pop()){
+            result.push_back(e.get());
+        }
+        std::vector<value_type> expected(n_elements+capacity);
+        std::iota(expected.begin(),expected.end(),value_type{0});
+        REQUIRE(result == expected);
+        REQUIRE(queue.size() == 0);
+        REQUIRE(queue.spilled() == 0);
+        //journal is drained, in memory queue is used again
+        queue.push(value_type{1});
+        REQUIRE(queue.spilled() == 0);
+        REQUIRE(queue.pop().get() == 1);
+    }
+}
+
+TEST_CASE("test_mpmc_spilling_queue_multithread","[test_mpmc_spilling_queue]")
+{
+    using value_type = std::size_t;
+    using queue_type = queue::mpmc_spilling_queue<value_type>;
+    static constexpr std::size_t capacity = 16;
+    static constexpr std::size_t n_producers = 4;
+    static constexpr std::size_t n_consumers = 4;
+    static constexpr std::size_t n_elements = 100*1000;
+    queue_type queue{capacity, test_spilling_queue::journal_file_name()};
+
+    std::array<std::thread, n_producers> producers;
+    std::array<std::thread, n_consumers> consumers;
+    std::array<std::vector<value_type>, n_consumers> results;
+    for (std::size_t i{0}; i!=n_producers; ++i){
+        producers[i] = std::thread([&queue,i](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                queue.push(i*n_elements+j);
+            }
+        });
+    }
+    for (std::size_t i{0}; i!=n_consumers; ++i){
+        consumers[i] = std::thread([&queue,&result = results[i]](){
+            for (std::size_t j{0}; j!=n_elements; ++j){
+                result.push_back(queue.pop().get());
+            }
+        });
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    std::for_each(consumers.begin(),consumers.end(),[](auto& t){t.join();});
+
+    std::vector<value_type> result{};
+    for (const auto& consumer_result : results){
+        //elements of every producer are popped by single consumer in order they were pushed
+        std::array<value_type, n_producers> last{};
+        for (const auto& v : consumer_result){
+            auto producer = v/n_elements;
+            REQUIRE(v+1 > last[producer]);
+            last[producer] = v+1;
+        }
+        result.insert(result.end(),consumer_result.begin(),consumer_result.end());
+    }
+    std::sort(result.begin(),result.end());
+    std::vector<value_type> expected(n_producers*n_elements);
+    std::iota(expected.begin(),expected.end(),value_type{0});
+    REQUIRE(result == expected);
+    REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE("test_mapped_journal","[test_mpmc_spilling_queue]")
+{
+    using value_type = std::size_t;
+    using journal_type = queue::detail::mapped_journal<value_type>;
+    static constexpr std::size_t capacity = 4;
+
+    SECTION("existing_file_is_not_touched"){
+        const auto file_name = test_spilling_queue::journal_file_name();
+        {
+            std::ofstream file{file_name};
+            file<<"data";
+        }
+        {
+            journal_type journal{file_name, capacity};
+            journal.push(1);
+        }
+        std::ifstream file{file_name};
+        std::string content{};
+        file>>content;
+        REQUIRE(content == "data");
+        file.close();
+        std::filesystem::remove(file_name);
+    }
+    SECTION("compact_and_grow"){
+        journal_type journal{test_spilling_queue::journal_file_name(), capacity};
+        value_type v{};
+        for (value_type i{0}; i!=capacity; ++i){
+            journal.push(i);
+        }
+        REQUIRE(journal.try_pop(v));
+        REQUIRE(v == 0);
+        REQUIRE(journal.try_pop(v));
+        REQUIRE(v == 1);
+        //half is popped, records are moved to the beginning of the file
+        journal.push(4);
+        journal.push(5);
+        REQUIRE(journal.capacity() == capacity);
+        REQUIRE(journal.size() == capacity);
+        //grow
+        journal.push(6);
+        REQUIRE(journal.capacity() == 2*capacity);
+        std::vector<value_type> result{};
+        while(journal.try_pop(v)){
+            result.push_back(v);
+        }
+        REQUIRE(result == std::vector<value_type>{2,3,4,5,6});
+        REQUIRE(journal.empty());
+    }
+}
@@ -1,8 +1,10 @@
 #include <string>
 #include <array>
 #include <atomic>
+#include <functional>
 #include <numeric>
 #include <vector>
+#include <ctime>
 #include "catch.hpp"
 #include "thread_pool.hpp"
 #include "benchmark_helpers.hpp"
@@ -43,7 +45,9 @@ struct v{
 
 TEMPLATE_TEST_CASE("test_thread_pool_v3_v4_void_result","[test_thread_pool_v3_v4]",
     thread_pool::thread_pool_v3,
-    thread_pool::thread_pool_v4
+    thread_pool::thread_pool_v4,
+    thread_pool::thread_pool_v5,
+    thread_pool::thread_pool_v6
 )
 {
     using thread_pool::task_future;
@@ -96,7 +100,9 @@ TEMPLATE_TEST_CASE("test_thread_pool_v3_v4_void_result","[test_thread_pool_v3_v4
 
 TEMPLATE_TEST_CASE("test_thread_pool_v3_v4_result","[test_thread_pool_v3_v4]",
     thread_pool::thread_pool_v3,
-    thread_pool::thread_pool_v4
+    thread_pool::thread_pool_v4,
+    thread_pool::thread_pool_v5,
+    thread_pool::thread_pool_v6
 )
 {
     using thread_pool::task_future;
@@ -128,7 +134,9 @@ TEMPLATE_TEST_CASE("test_thread_pool_v3_v4_result","[test_thread_pool_v3_v4]",
 
 TEMPLATE_TEST_CASE("test_thread_pool_v3_task_group","[test_thread_pool_v3]",
     thread_pool::thread_pool_v3,
-    thread_pool::thread_pool_v4
+    thread_pool::thread_pool_v4,
+    thread_pool::thread_pool_v5,
+    thread_pool::thread_pool_v6
 )
 {
     using thread_pool::task_group;
@@ -160,7 +168,9 @@ TEMPLATE_TEST_CASE("test_thread_pool_v3_task_group","[test_thread_pool_v3]",
 
 TEMPLATE_TEST_CASE("test_thread_pool_v3_task_group_many_tasks","[test_thread_pool_v3]",
     thread_pool::thread_pool_v3,
-    thread_pool::thread_pool_v4
+    thread_pool::thread_pool_v4,
+    thread_pool::thread_pool_v5,
+    thread_pool::thread_pool_v6
 )
 {
     using thread_pool::task_group;
@@ -208,4 +218,241 @@ TEMPLATE_TEST_CASE("test_thread_pool_v3_task_group_many_tasks","[test_thread_poo
     }
     group.wait();
     REQUIRE(counter == counter_);
-}
\ No newline at end of file
+}
+
+//tasks pushed from worker threads go to worker's deque, other workers steal them
+TEST_CASE("test_thread_pool_v5_nested_tasks","[test_thread_pool_v5]")
+{
+    using thread_pool::task_group;
+    using thread_pool_type = thread_pool::thread_pool_v5;
+
+    constexpr static std::size_t n_threads = 4;
+    constexpr static std::size_t depth = 12;
+    thread_pool_type pool{n_threads, 1024, 16};
+    task_group group{};
+    std::atomic<std::size_t> counter{0};
+
+    //binary tree of tasks, each task counts itself and pushes two children
+    std::function<void(std::size_t)> spawn = [&](std::size_t level){
+        counter.fetch_add(1);
+        if (level != 0){
+            pool.push_group(group, spawn, level-1);
+            pool.push_group(group, spawn, level-1);
+        }
+    };
+    pool.push_group(group, spawn, depth);
+    group.wait();
+    REQUIRE(counter.load() == (std::size_t{1}<<(depth+1))-1);
+
+    auto future = pool.push([&pool](){return pool.push([](){return 42;}).get();});
+    REQUIRE(future.get() == 42);
+}
+
+//small task queue, pushers wait for free slot
+TEST_CASE("test_thread_pool_v6_full_queue","[test_thread_pool_v6]")
+{
+    using thread_pool::task_group;
+    using thread_pool_type = thread_pool::thread_pool_v6;
+
+    constexpr static std::size_t n_threads = 4;
+    constexpr static std::size_t n_producers = 4;
+    constexpr static std::size_t n_tasks = 10*1000;
+    thread_pool_type pool{n_threads, 2};
+    task_group group{};
+    std::atomic<std::size_t> counter{0};
+    std::array<std::thread, n_producers> producers;
+    for (auto& producer : producers){
+        producer = std::thread([&](){
+            for (std::size_t i{0}; i!=n_tasks; ++i){
+                pool.push_group(group, [&counter](){counter.fetch_add(1);});
+            }
+        });
+    }
+    std::for_each(producers.begin(),producers.end(),[](auto& t){t.join();});
+    group.wait();
+    REQUIRE(counter.load() == n_producers*n_tasks);
+    REQUIRE(pool.push([](){return 42;}).get() == 42);
+}
+
+TEST_CASE("test_basic_task_v3","[test_basic_task_v3]")
+{
+    using thread_pool::task_group;
+    using task_type = thread_pool::task_v3;
+    static_assert(std::is_nothrow_move_constructible_v<task_type>);
+    static_assert(std::is_nothrow_move_assignable_v<task_type>);
+
+    std::size_t x{0};
+    std::array<std::size_t, 6> small{1,2,3,4,5,6};    //48 bytes capture
+    std::array<std::size_t, 32> big{};
+    big.fill(1);
+
+    SECTION("inline_task"){
+        task_type task{};
+        auto future = task.set_task(true, [small](std::size_t a){return std::accumulate(small.begin(),small.end(),a);}, std::size_t{1});
+        REQUIRE(task.is_inline());
+        task_type moved{std::move(task)};
+        REQUIRE(moved.is_inline());
+        REQUIRE(!task.is_inline());
+        task = std::move(moved);
+        task.call();
+        REQUIRE(future.get() == 22);
+    }
+    SECTION("heap_task"){
+        task_type task{};
+        auto future = task.set_task(true, [big](){return std::accumulate(big.begin(),big.end(),std::size_t{0});});
+        REQUIRE(!task.is_inline());
+        task_type moved{std::move(task)};
+        moved.call();
+        REQUIRE(future.get() == 32);
+    }
+    SECTION("group_task"){
+        task_group group{};
+        task_type task{};
+        group.inc();
+        task.set_group_task(group, [&x, small](){x = small.back();});
+        REQUIRE(task.is_inline());
+        task_type moved{std::move(task)};
+        moved.call();
+        group.wait();
+        REQUIRE(x == 6);
+    }
+    SECTION("reset_not_called_task"){
+        auto counter = std::make_shared<int>(0);
+        task_group group{};
+        {
+            task_type task{};
+            task.set_group_task(group, [counter](){});
+            REQUIRE(counter.use_count() == 2);
+            task.set_task(false, [counter](){});
+            REQUIRE(counter.use_count() == 2);
+        }
+        REQUIRE(counter.use_count() == 1);
+    }
+}
+
+TEST_CASE("test_light_promise","[test_light_promise]")
+{
+    using thread_pool::light_promise;
+    using thread_pool::light_future;
+
+    SECTION("value"){
+        light_promise<std::string> promise{};
+        auto future = promise.get_future();
+        REQUIRE(future.valid());
+        std::thread t{[&promise](){promise.set_value("abc");}};
+        REQUIRE(future.get() == "abc");
+        REQUIRE(!future.valid());
+        t.join();
+    }
+    SECTION("void"){
+        light_future<void> future{};
+        REQUIRE(!future.valid());
+        {
+            light_promise<void> promise{};
+            future = promise.get_future();
+            promise.set_value();
+        }
+        future.wait();
+        future.get();
+    }
+    SECTION("exception"){
+        light_promise<int> promise{};
+        auto future = promise.get_future();
+        promise.set_exception(std::make_exception_ptr(std::runtime_error{"error"}));
+        REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+    }
+    SECTION("broken_promise"){
+        auto promise = std::make_unique<light_promise<int>>();
+        auto future = promise->get_future();
+        promise.reset();
+        REQUIRE_THROWS_AS(future.get(), std::future_error);
+    }
+    SECTION("future_destroyed_first"){
+        light_promise<std::vector<int>> promise{};
+        promise.get_future();
+        promise.set_value(std::vector<int>(10,1));
+    }
+    //waiting thread uses almost no cpu
+    SECTION("waiter_is_blocked"){
+        light_promise<int> promise{};
+        auto future = promise.get_future();
+        std::thread t{[&promise](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            promise.set_value(1);
+        }};
+        const auto cpu_start = std::clock();
+        REQUIRE(future.get() == 1);
+        const auto cpu_ms = 1000.0*static_cast<double>(std::clock()-cpu_start)/CLOCKS_PER_SEC;
+        REQUIRE(cpu_ms < 100);
+        t.join();
+    }
+}
+
+TEMPLATE_TEST_CASE("test_thread_pool_light_promise","[test_thread_pool_light_promise]",
+    thread_pool::thread_pool_v3,
+    thread_pool::thread_pool_v4,
+    thread_pool::thread_pool_v5,
+    thread_pool::thread_pool_v6
+)
+{
+    using thread_pool::light_promise;
+    using thread_pool_type = TestType;
+    using value_type = std::size_t;
+
+    constexpr static std::size_t n_threads = 4;
+    constexpr static std::size_t n_tasks = 10*1000;
+    thread_pool_type pool{n_threads};
+    std::atomic<value_type> counter{0};
+    std::vector<thread_pool::task_future<value_type, thread_pool::light_future<value_type>>> futures{};
+    for (std::size_t i{0}; i!=n_tasks; ++i){
+        if (i%2){
+            futures.push_back(pool.template push<light_promise>([](auto x){return x;}, i));
+        }else{
+            futures.push_back(pool.template push_async<light_promise>([](auto x){return x;}, i));
+        }
+        pool.template push_async<light_promise>([&counter](){counter.fetch_add(1);});
+    }
+    value_type result_sum{0};
+    std::for_each(futures.begin(), futures.end(), [&result_sum](auto& f){result_sum+=f.get();});
+    REQUIRE(result_sum == n_tasks*(n_tasks-1)/2);
+    pool.template push<light_promise>([](){}).wait();
+    while(counter.load() != n_tasks){
+        std::this_thread::yield();
+    }
+}
+
+TEMPLATE_TEST_CASE("test_thread_pool_push_detached","[test_thread_pool_push_detached]",
+    thread_pool::thread_pool_v3,
+    thread_pool::thread_pool_v4,
+    thread_pool::thread_pool_v5,
+    thread_pool::thread_pool_v6
+)
+{
+    using thread_pool_type = TestType;
+
+    constexpr static std::size_t n_threads = 4;
+    constexpr static std::size_t n_tasks = 10*1000;
+    std::atomic<std::size_t> counter{0};
+    std::atomic<std::size_t> errors{0};
+    thread_pool_type pool{n_threads, [&errors](std::exception_ptr e){
+        try{
+            std::rethrow_exception(e);
+        }catch(const std::runtime_error&){
+            errors.fetch_add(1);
+        }
+    }};
+    auto f = [&counter](std::size_t i){
+        counter.fetch_add(1);
+        if (i%10 == 0){
+            throw std::runtime_error{"error"};
+        }
+    };
+    for (std::size_t i{0}; i!=n_tasks; ++i){
+        pool.push_detached(f, i);
+    }
+    while(counter.load() != n_tasks || errors.load() != n_tasks/10){
+        std::this_thread::yield();
+    }
+    REQUIRE(counter.load() == n_tasks);
+    REQUIRE(errors.load() == n_tasks/10);
+}